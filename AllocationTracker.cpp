@@ -0,0 +1,343 @@
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <cstdlib>
+#include <malloc.h>
+#include <sys/resource.h>
+
+#include "AllocationTracker.hpp"
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Counters of one thread. They are initialized without running code, so they are usable in operator
+/// new before anything of the thread has been constructed.
+///
+struct ThreadAllocations
+{
+  AllocationSnapshot counts;
+  AllocationSubsystem subsystem = AllocationSubsystem::OTHER;
+  bool registered = false;
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Adds the counters of a thread to the totals when the thread ends
+///
+struct ThreadRollup
+{
+  ~ThreadRollup();
+};
+
+static std::atomic<bool> tracking_enabled{false};
+static std::atomic<int64_t> live_bytes{0};
+static std::atomic<int64_t> peak_bytes{0};
+static std::mutex finished_threads_mutex;
+static AllocationSnapshot finished_threads;
+static thread_local ThreadAllocations thread_allocations;
+
+ThreadRollup::~ThreadRollup()
+{
+  std::lock_guard<std::mutex> lock(finished_threads_mutex);
+  finished_threads += thread_allocations.counts;
+  thread_allocations.counts = AllocationSnapshot();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Counts an allocation for the current subsystem of the calling thread
+///
+/// @param size requested size
+/// @param live bytes in use including the allocation
+///
+/// @return nothing
+static void countAllocation(size_t size, int64_t live)
+{
+  ThreadAllocations &thread = thread_allocations;
+  if (!thread.registered)
+  {
+    // set first, registering the thread may allocate itself
+    thread.registered = true;
+    static thread_local ThreadRollup rollup;
+    (void)rollup;
+  }
+  AllocationCounts &counts = thread.counts.subsystems[static_cast<int>(thread.subsystem)];
+  counts.count++;
+  counts.bytes += size;
+
+  int64_t peak = peak_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+  {
+  }
+}
+
+void *operator new(size_t size)
+{
+  void *memory = std::malloc(size ? size : 1);
+  if (memory == nullptr)
+    throw std::bad_alloc();
+  // the bytes in use are counted from the start, so freeing older blocks after enable() is balanced
+  int64_t usable = static_cast<int64_t>(malloc_usable_size(memory));
+  int64_t live = live_bytes.fetch_add(usable, std::memory_order_relaxed) + usable;
+  if (tracking_enabled.load(std::memory_order_relaxed))
+    countAllocation(size, live);
+  return memory;
+}
+
+void operator delete(void *memory) noexcept
+{
+  if (memory != nullptr)
+    live_bytes.fetch_sub(static_cast<int64_t>(malloc_usable_size(memory)), std::memory_order_relaxed);
+  std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+  operator delete(memory);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Sums the counts of all subsystems
+///
+/// @return total counts
+AllocationCounts AllocationSnapshot::total() const
+{
+  AllocationCounts total;
+  for (const AllocationCounts &counts : subsystems)
+    total += counts;
+  return total;
+}
+
+AllocationSnapshot AllocationSnapshot::operator-(const AllocationSnapshot &other) const
+{
+  AllocationSnapshot difference;
+  for (int subsystem = 0; subsystem < ALLOCATION_SUBSYSTEM_COUNT; subsystem++)
+    difference.subsystems[subsystem] = subsystems[subsystem] - other.subsystems[subsystem];
+  return difference;
+}
+
+AllocationSnapshot &AllocationSnapshot::operator+=(const AllocationSnapshot &other)
+{
+  for (int subsystem = 0; subsystem < ALLOCATION_SUBSYSTEM_COUNT; subsystem++)
+    subsystems[subsystem] += other.subsystems[subsystem];
+  return *this;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Starts counting the allocations. The bytes in use are always counted, they include memory allocated
+/// before.
+///
+/// @return nothing
+void AllocationTracker::enable()
+{
+  tracking_enabled.store(true, std::memory_order_relaxed);
+}
+
+bool AllocationTracker::isEnabled()
+{
+  return tracking_enabled.load(std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Returns the counters of the calling thread
+///
+/// @return allocations of the calling thread so far
+AllocationSnapshot AllocationTracker::threadSnapshot()
+{
+  return thread_allocations.counts;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Returns the allocations of all threads that have ended, of all finished scheduler jobs and of the
+/// calling thread. Jobs that are still running are not included, the bots wait for their jobs before
+/// they return an action.
+///
+/// @return allocations so far
+AllocationSnapshot AllocationTracker::totals()
+{
+  AllocationSnapshot totals = thread_allocations.counts;
+  std::lock_guard<std::mutex> lock(finished_threads_mutex);
+  totals += finished_threads;
+  return totals;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Moves the allocations the calling thread has made since a snapshot from its own counters to the
+/// totals, e.g. those of a job run by a scheduler thread that never ends. The counters of the thread
+/// are the same as at the snapshot afterwards.
+///
+/// @param before counters of the calling thread at the snapshot, see threadSnapshot()
+///
+/// @return nothing
+void AllocationTracker::rollupSince(const AllocationSnapshot &before)
+{
+  AllocationSnapshot made = thread_allocations.counts - before;
+  thread_allocations.counts = before;
+  std::lock_guard<std::mutex> lock(finished_threads_mutex);
+  finished_threads += made;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Starts a new high-water mark at the bytes in use right now, e.g. at the start of a game
+///
+/// @return bytes in use
+int64_t AllocationTracker::resetPeak()
+{
+  int64_t live = live_bytes.load(std::memory_order_relaxed);
+  peak_bytes.store(live, std::memory_order_relaxed);
+  return live;
+}
+
+int64_t AllocationTracker::getPeakBytes()
+{
+  return peak_bytes.load(std::memory_order_relaxed);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Returns the peak resident memory of the process as reported by the system
+///
+/// @return peak resident memory in kilobytes, 0 = not available
+long AllocationTracker::getPeakResidentKilobytes()
+{
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+  return usage.ru_maxrss;
+}
+
+const char *AllocationTracker::subsystemName(AllocationSubsystem subsystem)
+{
+  switch (subsystem)
+  {
+  case AllocationSubsystem::CARDS:
+    return "cards";
+  case AllocationSubsystem::BOARD:
+    return "board";
+  case AllocationSubsystem::COMMANDS:
+    return "commands";
+  case AllocationSubsystem::MESSAGES:
+    return "messages";
+  case AllocationSubsystem::OTHER:
+    break;
+  }
+  return "other";
+}
+
+AllocationScope::AllocationScope(AllocationSubsystem subsystem) : previous_(thread_allocations.subsystem)
+{
+  thread_allocations.subsystem = subsystem;
+}
+
+AllocationScope::~AllocationScope()
+{
+  thread_allocations.subsystem = previous_;
+}
+
+AllocationReport::AllocationReport() : peak_bytes_(0), games_(0) {}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Adds the allocations of one action of the game
+///
+/// @param type type of the command
+/// @param round round the action was played in
+/// @param counts allocations of the game thread while the action was applied
+///
+/// @return nothing
+void AllocationReport::addAction(CommandType type, int round, const AllocationCounts &counts)
+{
+  commands_[type] += counts;
+  if (round < 0)
+    return;
+  if (static_cast<unsigned long>(round) >= rounds_.size())
+    rounds_.resize(round + 1);
+  rounds_[round] += counts;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Adds the allocations of a finished game
+///
+/// @param subsystems allocations of all threads during the game
+/// @param peak_bytes heap high-water mark of the game
+///
+/// @return nothing
+void AllocationReport::finishGame(const AllocationSnapshot &subsystems, int64_t peak_bytes)
+{
+  subsystems_ += subsystems;
+  if (peak_bytes > peak_bytes_)
+    peak_bytes_ = peak_bytes;
+  games_++;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Rolls the report of another game or thread into this one, the high-water mark is the highest of both
+///
+/// @param other report to add
+///
+/// @return nothing
+void AllocationReport::merge(const AllocationReport &other)
+{
+  subsystems_ += other.subsystems_;
+  for (const auto &command : other.commands_)
+    commands_[command.first] += command.second;
+  if (other.rounds_.size() > rounds_.size())
+    rounds_.resize(other.rounds_.size());
+  for (unsigned long round = 0; round < other.rounds_.size(); round++)
+    rounds_[round] += other.rounds_[round];
+  if (other.peak_bytes_ > peak_bytes_)
+    peak_bytes_ = other.peak_bytes_;
+  games_ += other.games_;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Prints one line of counts
+///
+/// @param out stream to print to
+/// @param name name of the line
+/// @param counts counts to print
+///
+/// @return nothing
+static void printCounts(std::ostream &out, const std::string &name, const AllocationCounts &counts)
+{
+  out << "  " << name << ": " << counts.count << " allocations, " << counts.bytes << " bytes" << std::endl;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Prints the report, per subsystem, per command type and per round
+///
+/// @param out stream to print to
+///
+/// @return nothing
+void AllocationReport::print(std::ostream &out) const
+{
+  AllocationCounts total = subsystems_.total();
+  out << "Allocations in " << games_ << (games_ == 1 ? " game: " : " games: ") << total.count
+      << " allocations, " << total.bytes << " bytes, heap high-water " << peak_bytes_ << " bytes, peak resident "
+      << AllocationTracker::getPeakResidentKilobytes() << " KB" << std::endl;
+
+  out << "By subsystem:" << std::endl;
+  for (int subsystem = 0; subsystem < ALLOCATION_SUBSYSTEM_COUNT; subsystem++)
+    printCounts(out, AllocationTracker::subsystemName(static_cast<AllocationSubsystem>(subsystem)),
+                subsystems_.subsystems[subsystem]);
+
+  out << "By command:" << std::endl;
+  for (const auto &command : commands_)
+    printCounts(out, Command(command.first).toString(), command.second);
+
+  out << "By round:" << std::endl;
+  for (unsigned long round = 0; round < rounds_.size(); round++)
+  {
+    if (rounds_[round].count)
+      printCounts(out, std::to_string(round), rounds_[round]);
+  }
+}
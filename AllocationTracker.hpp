@@ -0,0 +1,128 @@
+#ifndef ALLOCATIONTRACKER_HPP
+#define ALLOCATIONTRACKER_HPP
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+#include "Command.hpp"
+
+#define ALLOCATION_SUBSYSTEM_COUNT 5
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Parts of the program the allocations are counted for. An allocation belongs to the innermost
+/// AllocationScope of its thread, everything outside of a scope is OTHER.
+///
+enum class AllocationSubsystem : uint8_t
+{
+  OTHER,
+  CARDS,
+  BOARD,
+  COMMANDS,
+  MESSAGES
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Number and size of allocations
+///
+struct AllocationCounts
+{
+  uint64_t count = 0;
+  uint64_t bytes = 0;
+
+  AllocationCounts &operator+=(const AllocationCounts &other)
+  {
+    count += other.count;
+    bytes += other.bytes;
+    return *this;
+  }
+  AllocationCounts operator-(const AllocationCounts &other) const
+  {
+    return {count - other.count, bytes - other.bytes};
+  }
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Allocation counts of every subsystem
+///
+struct AllocationSnapshot
+{
+  AllocationCounts subsystems[ALLOCATION_SUBSYSTEM_COUNT];
+
+  AllocationCounts total() const;
+  AllocationSnapshot operator-(const AllocationSnapshot &other) const;
+  AllocationSnapshot &operator+=(const AllocationSnapshot &other);
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Counts the allocations of the program through the global operator new. Tracking is off until
+/// enable() is called, then every thread counts its allocations in its own counters, without any
+/// locking. The counters of a thread are added to the totals when the thread ends; the worker threads
+/// of the job scheduler never end, they add the allocations of every job to the totals when the job
+/// has finished. Only the bytes in use are shared between the threads, for the heap high-water mark;
+/// they are counted from the start of the program, so blocks allocated before enable() can be freed.
+///
+class AllocationTracker
+{
+public:
+  static void enable();
+  static bool isEnabled();
+  static AllocationSnapshot threadSnapshot();
+  static AllocationSnapshot totals();
+  static void rollupSince(const AllocationSnapshot &before);
+  static int64_t resetPeak();
+  static int64_t getPeakBytes();
+  static long getPeakResidentKilobytes();
+  static const char *subsystemName(AllocationSubsystem subsystem);
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Counts the allocations of the calling thread for a subsystem until the scope ends
+///
+class AllocationScope
+{
+protected:
+  AllocationSubsystem previous_;
+
+public:
+  // Forward declarations
+  explicit AllocationScope(AllocationSubsystem subsystem);
+  AllocationScope(const AllocationScope &) = delete;
+  ~AllocationScope();
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Allocations of one game or, merged, of a whole batch: per subsystem, per command type and per
+/// round, together with the heap high-water mark. The command and round numbers only count the game
+/// thread, the subsystem numbers include the searches of the bots.
+///
+class AllocationReport
+{
+protected:
+  AllocationSnapshot subsystems_;
+  std::map<CommandType, AllocationCounts> commands_;
+  std::vector<AllocationCounts> rounds_;
+  int64_t peak_bytes_;
+  unsigned long games_;
+
+public:
+  // Forward declarations
+  AllocationReport();
+  ~AllocationReport() = default;
+
+  void addAction(CommandType type, int round, const AllocationCounts &counts);
+  void finishGame(const AllocationSnapshot &subsystems, int64_t peak_bytes);
+  void merge(const AllocationReport &other);
+  void print(std::ostream &out) const;
+  int64_t getPeakBytes() const { return peak_bytes_; }
+  AllocationCounts getTotal() const { return subsystems_.total(); }
+};
+
+#endif
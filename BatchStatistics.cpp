@@ -0,0 +1,196 @@
+#include <vector>
+#include <algorithm>
+
+#include "BatchStatistics.hpp"
+#include "Creature.hpp"
+#include "Game.hpp"
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Counts one event of the match
+///
+/// @param type type of the event
+/// @param player player the event belongs to
+/// @param value value of the event, e.g. the damage of a direct attack
+/// @param trait trait of a trait event
+///
+/// @return nothing
+void MatchCounters::addEvent(EventType type, int player, int value, char trait)
+{
+  switch (type)
+  {
+  case EventType::SPELL:
+    spells++;
+    break;
+  case EventType::FIGHT:
+    fights++;
+    break;
+  case EventType::DEATH:
+    deaths++;
+    break;
+  case EventType::DIRECT_ATTACK:
+    if (player == 1 || player == 2)
+      damage[player - 1] += value;
+    break;
+  case EventType::TRAIT:
+    traits[Creature::traitFromChar(trait)]++;
+    break;
+  case EventType::UNDYING:
+    traits[Trait::U]++;
+    break;
+  case EventType::TEMPORARY:
+    traits[Trait::T]++;
+    break;
+  case EventType::ROUND_START:
+  case EventType::GAME_END:
+    break;
+  }
+}
+
+MatchCounters &MatchCounters::operator+=(const MatchCounters &other)
+{
+  spells += other.spells;
+  fights += other.fights;
+  deaths += other.deaths;
+  damage[0] += other.damage[0];
+  damage[1] += other.damage[1];
+  for (int trait = 0; trait < STATISTICS_TRAIT_COUNT; trait++)
+    traits[trait] += other.traits[trait];
+  return *this;
+}
+
+StatisticsAccumulator::StatisticsAccumulator() : matches_(0), rounds_(0), wins_{0, 0, 0} {}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Adds a finished match
+///
+/// @param result result of the match
+/// @param counters counters of the match
+/// @param decks deck of player 1 and player 2
+///
+/// @return nothing
+void StatisticsAccumulator::addMatch(const ResultRecord &result, const MatchCounters &counters,
+                                     const std::string (&decks)[2])
+{
+  int winner = Game::winnerFromStatus(result.game_status);
+  matches_++;
+  rounds_ += result.rounds;
+  wins_[winner]++;
+  counters_ += counters;
+  for (int player = 0; player < 2; player++)
+  {
+    DeckRecord &deck = decks_[decks[player]];
+    deck.matches++;
+    if (winner == player + 1)
+      deck.wins++;
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Adds the totals of another simulation thread
+///
+/// @param other accumulator to add
+///
+/// @return nothing
+void StatisticsAccumulator::merge(const StatisticsAccumulator &other)
+{
+  matches_ += other.matches_;
+  rounds_ += other.rounds_;
+  for (int winner = 0; winner < 3; winner++)
+    wins_[winner] += other.wins_[winner];
+  counters_ += other.counters_;
+  for (const auto &deck : other.decks_)
+  {
+    DeckRecord &record = decks_[deck.first];
+    record.matches += deck.second.matches;
+    record.wins += deck.second.wins;
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Prints the statistics, the decks that played the most matches first
+///
+/// @param out stream to print to
+///
+/// @return nothing
+void StatisticsAccumulator::print(std::ostream &out) const
+{
+  out << "Statistics of " << matches_ << " matches:" << std::endl;
+  if (matches_)
+    out << "  average rounds: " << static_cast<double>(rounds_) / matches_ << std::endl;
+  out << "  direct attack damage: Player 1 " << counters_.damage[0] << ", Player 2 " << counters_.damage[1]
+      << std::endl;
+  out << "  spells cast: " << counters_.spells << ", fights: " << counters_.fights
+      << ", creatures died: " << counters_.deaths << std::endl;
+  out << "  traits triggered:";
+  for (int trait = Trait::B; trait < STATISTICS_TRAIT_COUNT; trait++)
+    out << (trait == Trait::B ? " " : ", ") << Creature::nameFromTrait(static_cast<Trait>(trait)) << " "
+        << counters_.traits[trait];
+  out << std::endl;
+
+  std::vector<std::pair<std::string, DeckRecord>> decks(decks_.begin(), decks_.end());
+  std::stable_sort(decks.begin(), decks.end(),
+                   [](const std::pair<std::string, DeckRecord> &first,
+                      const std::pair<std::string, DeckRecord> &second)
+                   { return first.second.matches > second.second.matches; });
+  out << "  wins per deck:" << std::endl;
+  for (unsigned long index = 0; index < decks.size() && index < STATISTICS_DECK_LIMIT; index++)
+    out << "    " << decks[index].first << ": " << decks[index].second.wins << " of "
+        << decks[index].second.matches << std::endl;
+  if (decks.size() > STATISTICS_DECK_LIMIT)
+    out << "    ... " << decks.size() - STATISTICS_DECK_LIMIT << " more decks" << std::endl;
+}
+
+ProgressSnapshot &ProgressSnapshot::operator+=(const ProgressSnapshot &other)
+{
+  matches += other.matches;
+  rounds += other.rounds;
+  for (int winner = 0; winner < 3; winner++)
+    wins[winner] += other.wins[winner];
+  return *this;
+}
+
+ProgressSlot::ProgressSlot() : sequence_(0), matches_(0), rounds_(0), wins_{0, 0, 0} {}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Publishes the progress of the owning thread, never waits
+///
+/// @param accumulator totals of the owning thread
+///
+/// @return nothing
+void ProgressSlot::publish(const StatisticsAccumulator &accumulator)
+{
+  uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+  sequence_.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  matches_.store(accumulator.getMatches(), std::memory_order_relaxed);
+  rounds_.store(accumulator.getRounds(), std::memory_order_relaxed);
+  for (int winner = 0; winner < 3; winner++)
+    wins_[winner].store(accumulator.getWins(winner), std::memory_order_relaxed);
+  sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Reads the last published progress
+///
+/// @return consistent snapshot of the owning thread
+ProgressSnapshot ProgressSlot::read() const
+{
+  ProgressSnapshot snapshot;
+  while (true)
+  {
+    uint64_t before = sequence_.load(std::memory_order_acquire);
+    snapshot.matches = matches_.load(std::memory_order_relaxed);
+    snapshot.rounds = rounds_.load(std::memory_order_relaxed);
+    for (int winner = 0; winner < 3; winner++)
+      snapshot.wins[winner] = wins_[winner].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (!(before & 1) && sequence_.load(std::memory_order_relaxed) == before)
+      return snapshot;
+  }
+}
@@ -0,0 +1,106 @@
+#ifndef BATCHSTATISTICS_HPP
+#define BATCHSTATISTICS_HPP
+
+#include <iostream>
+#include <string>
+#include <map>
+#include <atomic>
+#include <cstdint>
+
+#include "EventLog.hpp"
+#include "ResultsLog.hpp"
+
+#define STATISTICS_CACHE_LINE 64
+#define STATISTICS_TRAIT_COUNT 11
+#define STATISTICS_DECK_LIMIT 10
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Counters of one match, filled by the game from its events. Only the thread that plays the match
+/// writes them.
+///
+struct MatchCounters
+{
+  uint64_t spells = 0;
+  uint64_t fights = 0;
+  uint64_t deaths = 0;
+  uint64_t damage[2] = {0, 0};
+  uint64_t traits[STATISTICS_TRAIT_COUNT] = {};
+
+  void addEvent(EventType type, int player, int value, char trait);
+  MatchCounters &operator+=(const MatchCounters &other);
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Totals of the matches played by one simulation thread. Every thread owns one accumulator and is the
+/// only one writing it, so adding a match needs no locking; the accumulators are aligned to cache lines,
+/// so threads writing their own accumulators do not slow each other down. They are merged when the
+/// threads have finished.
+///
+class alignas(STATISTICS_CACHE_LINE) StatisticsAccumulator
+{
+protected:
+  struct DeckRecord
+  {
+    uint64_t matches = 0;
+    uint64_t wins = 0;
+  };
+
+  uint64_t matches_;
+  uint64_t rounds_;
+  uint64_t wins_[3];
+  MatchCounters counters_;
+  std::map<std::string, DeckRecord> decks_;
+
+public:
+  // Forward declarations
+  StatisticsAccumulator();
+  ~StatisticsAccumulator() = default;
+
+  void addMatch(const ResultRecord &result, const MatchCounters &counters, const std::string (&decks)[2]);
+  void merge(const StatisticsAccumulator &other);
+  void print(std::ostream &out) const;
+  uint64_t getMatches() const { return matches_; }
+  uint64_t getRounds() const { return rounds_; }
+  uint64_t getWins(int winner) const { return wins_[winner]; }
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Progress of all simulation threads as far as they have published it
+///
+struct ProgressSnapshot
+{
+  uint64_t matches = 0;
+  uint64_t rounds = 0;
+  uint64_t wins[3] = {0, 0, 0};
+
+  ProgressSnapshot &operator+=(const ProgressSnapshot &other);
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Progress of one simulation thread for the live view. The thread publishes a new snapshot after every
+/// match without waiting for anyone: a sequence number is odd while it writes, readers retry until they
+/// have read a snapshot with the same even number before and after. Every slot has its own cache line.
+///
+class alignas(STATISTICS_CACHE_LINE) ProgressSlot
+{
+protected:
+  std::atomic<uint64_t> sequence_;
+  std::atomic<uint64_t> matches_;
+  std::atomic<uint64_t> rounds_;
+  std::atomic<uint64_t> wins_[3];
+
+public:
+  // Forward declarations
+  ProgressSlot();
+  ProgressSlot(const ProgressSlot &) = delete;
+  ~ProgressSlot() = default;
+
+  void publish(const StatisticsAccumulator &accumulator);
+  ProgressSnapshot read() const;
+};
+
+#endif
@@ -1,7 +1,10 @@
+#include <bit>
+
 #include "Board.hpp"
 #include "Game.hpp"
+#include "AllocationTracker.hpp"
 
-Board::Board() : is_active_(true)
+Board::Board() : is_active_(true), dying_(0), field_occupied_{0, 0}, battle_occupied_{0, 0}
 {
   field_zone_[0].resize(7, nullptr);
   field_zone_[1].resize(7, nullptr);
@@ -22,100 +25,102 @@ Board::~Board()
 /// @param defender defending player of the current round
 /// @param border_A border A
 /// @param border_B border B
+/// @param out stream the board is printed to
 ///
 /// @return nothing
 //
-void Board::printBoard(int defender, std::string border_A, std::string border_B) const
+void Board::printBoard(int defender, std::string border_A, std::string border_B, std::ostream &out) const
 {
+  AllocationScope scope(AllocationSubsystem::BOARD);
   if (!is_active_)
     return;
 
   int attacker = (defender == 1) ? 2 : 1;
-  std::cout << "================================== DEFENDER: PLAYER " << defender << " ===================================\n";
+  out << "================================== DEFENDER: PLAYER " << defender << " ===================================\n";
 
   for (int row = 0; row < 4; row++)
   {
-    std::cout << "F  ";
+    out << "F  ";
     for (int card_per_row_count = 0; card_per_row_count < 7; card_per_row_count++)
     {
-      std::cout << " ";
+      out << " ";
       if (field_zone_[defender - 1][card_per_row_count] != nullptr)
       {
-        std::cout << field_zone_[defender - 1][card_per_row_count]->printCard()[row];
+        out << field_zone_[defender - 1][card_per_row_count]->printCard()[row];
       }
       else
       {
-        std::cout << "         ";
+        out << "         ";
       }
-      std::cout << "  ";
+      out << "  ";
     }
-    std::cout << " F\n";
+    out << " F\n";
   }
 
-  std::cout << border_A << std::endl;
+  out << border_A << std::endl;
 
   for (int row = 0; row < 4; row++)
   {
-    std::cout << "B  ";
+    out << "B  ";
     for (int card_per_row_count = 0; card_per_row_count < 7; card_per_row_count++)
     {
-      std::cout << " ";
+      out << " ";
       if (battle_zone_[defender - 1][card_per_row_count] != nullptr)
       {
-        std::cout << battle_zone_[defender - 1][card_per_row_count]->printCard()[row];
+        out << battle_zone_[defender - 1][card_per_row_count]->printCard()[row];
       }
       else
       {
-        std::cout << "         ";
+        out << "         ";
       }
-      std::cout << "  ";
+      out << "  ";
     }
-    std::cout << " B\n";
+    out << " B\n";
   }
 
-  std::cout << border_B << std::endl;
+  out << border_B << std::endl;
 
   for (int row = 0; row < 4; row++)
   {
-    std::cout << "B  ";
+    out << "B  ";
     for (int card_per_row_count = 0; card_per_row_count < 7; card_per_row_count++)
     {
-      std::cout << " ";
+      out << " ";
       if (battle_zone_[attacker - 1][card_per_row_count] != nullptr)
       {
-        std::cout << battle_zone_[attacker - 1][card_per_row_count]->printCard()[row];
+        out << battle_zone_[attacker - 1][card_per_row_count]->printCard()[row];
       }
       else
       {
-        std::cout << "         ";
+        out << "         ";
       }
-      std::cout << "  ";
+      out << "  ";
     }
-    std::cout << " B\n";
+    out << " B\n";
   }
 
-  std::cout << border_A << std::endl;
+  out << border_A << std::endl;
 
   for (int row = 0; row < 4; row++)
   {
-    std::cout << "F  ";
+    out << "F  ";
     for (int card_per_row_count = 0; card_per_row_count < 7; card_per_row_count++)
     {
-      std::cout << " ";
+      out << " ";
       if (field_zone_[attacker - 1][card_per_row_count] != nullptr)
       {
-        std::cout << field_zone_[attacker - 1][card_per_row_count]->printCard()[row];
+        out << field_zone_[attacker - 1][card_per_row_count]->printCard()[row];
       }
       else
       {
-        std::cout << "         ";
+        out << "         ";
       }
-      std::cout << "  ";
+      out << "  ";
     }
-    std::cout << " F\n";
+    out << " F\n";
   }
 
-  std::cout << "================================== ATTACKER: PLAYER " << attacker << " ===================================\n";
+  out << "================================== ATTACKER: PLAYER " << attacker << " ===================================\n";
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -131,193 +136,192 @@ void Board::placeCard(std::shared_ptr<Creature> card, int player, int fieldSlot)
 {
   if (fieldSlot == -1)
   {
-    for (int slot = 0; slot < 7; slot++)
-    {
-      if (field_zone_[player][slot] == nullptr)
-      {
-        field_zone_[player][slot] = card;
-        return;
-      }
-    }
+    fieldSlot = findFreeFieldSlot(player);
+    if (fieldSlot == -1)
+      return;
   }
-  else
-    field_zone_[player][fieldSlot] = card;
+  setLocation(card.get(), false, player - 1, fieldSlot);
+  field_zone_[player - 1][fieldSlot] = card;
+  updateOccupancy(player - 1, fieldSlot);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// Fetches a card from the battle zone
+/// Places a card in the battle zone, and removes it from the field zone
 ///
+/// @param card card to be placed
 /// @param player player number
-/// @param slot slot number
+/// @param battle_pos battle position
+/// @param field_pos field position
 ///
-/// @return card from the battle zone, nullptr = slot empty
-std::shared_ptr<Creature> Board::fetchBattleCard(int player, int slot)
+/// @return nothing
+void Board::placeCardInBattle(std::shared_ptr<Creature> card, int player, int battle_pos, int field_pos)
 {
-  return battle_zone_[player - 1][slot];
+  setLocation(card.get(), true, player - 1, battle_pos);
+  battle_zone_[player - 1][battle_pos] = std::move(card);
+  field_zone_[player - 1][field_pos] = nullptr;
+  updateOccupancy(player - 1, battle_pos);
+  updateOccupancy(player - 1, field_pos);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// Fetches a card from the field zone
+/// Moves a creature from the field zone into the battle zone of the same player
 ///
 /// @param player player number
-/// @param slot slot number
+/// @param field_pos field position of the creature
+/// @param battle_pos battle position
 ///
-/// @return card from the field zone, nullptr = slot empty
-std::shared_ptr<Creature> Board::fetchFieldCard(int player, int slot)
+/// @return nothing
+void Board::moveCardToBattle(int player, int field_pos, int battle_pos)
 {
-  return field_zone_[player - 1][slot];
+  setLocation(field_zone_[player - 1][field_pos].get(), true, player - 1, battle_pos);
+  battle_zone_[player - 1][battle_pos] = std::move(field_zone_[player - 1][field_pos]);
+  updateOccupancy(player - 1, battle_pos);
+  updateOccupancy(player - 1, field_pos);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// Places a card in the battle zone, and removes it from the field zone
+/// Removes a card from the battle zone and hands it over to the caller
 ///
-/// @param card card to be placed
 /// @param player player number
-/// @param battle_pos battle position
-/// @param field_pos field position
+/// @param slot slot number
 ///
-/// @return nothing
-void Board::placeCardInBattle(std::shared_ptr<Creature> card, int player, int battle_pos, int field_pos)
+/// @return removed card, nullptr = slot was empty
+std::shared_ptr<Creature> Board::takeBattleCard(int player, int slot)
 {
-  battle_zone_[player - 1][battle_pos] = card;
-  field_zone_[player - 1][field_pos] = nullptr;
+  if (battle_zone_[player - 1][slot] != nullptr)
+    battle_zone_[player - 1][slot]->setBoardLocation(-1);
+  battle_occupied_[player - 1] &= static_cast<uint8_t>(~(1u << slot));
+  return std::move(battle_zone_[player - 1][slot]);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// Checks if a field slot is occupied
+/// Removes a card from the field zone and hands it over to the caller
 ///
 /// @param player player number
 /// @param slot slot number
 ///
-/// @return true = occupied, false = not occupied
-bool Board::isFieldSlotOccupied(int player, int slot) const
+/// @return removed card, nullptr = slot was empty
+std::shared_ptr<Creature> Board::takeFieldCard(int player, int slot)
 {
-  return field_zone_[player][slot] != nullptr;
+  if (field_zone_[player - 1][slot] != nullptr)
+    field_zone_[player - 1][slot]->setBoardLocation(-1);
+  field_occupied_[player - 1] &= static_cast<uint8_t>(~(1u << slot));
+  return std::move(field_zone_[player - 1][slot]);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// Checks if a battle slot is occupied
+/// Replaces every creature on the board with its own copy, so a copied board can be changed without
+/// affecting the board it was copied from
 ///
-/// @param player player number
-/// @param slot slot number
+/// @param arena arena the copies are created in, nullptr = heap
 ///
-/// @return true = occupied, false = not occupied
-bool Board::isBattleSlotOccupied(int player, int slot) const
+/// @return nothing
+void Board::detachCards(const std::shared_ptr<CardArena> &arena)
 {
-  return battle_zone_[player][slot] != nullptr;
+  AllocationScope scope(AllocationSubsystem::BOARD);
+  for (int player = 0; player < 2; player++)
+  {
+    for (int slot = 0; slot < 7; slot++)
+    {
+      if (field_zone_[player][slot] != nullptr)
+        field_zone_[player][slot] = allocateCard<Creature>(arena, *field_zone_[player][slot]);
+      if (battle_zone_[player][slot] != nullptr)
+        battle_zone_[player][slot] = allocateCard<Creature>(arena, *battle_zone_[player][slot]);
+    }
+  }
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// Removes a card from the battle zone
+/// Gives a creature its slot on the board. A creature that is dead already is added to the dying slots.
 ///
-/// @param player player number
-/// @param slot slot number
+/// @param creature creature that is placed
+/// @param battle true = battle zone, false = field zone
+/// @param player player index (0 or 1)
+/// @param slot slot
 ///
 /// @return nothing
-void Board::removeCardFromBattle(int player, int slot)
+void Board::setLocation(Creature *creature, bool battle, int player, int slot)
 {
-  battle_zone_[player - 1][slot] = nullptr;
+  if (creature == nullptr)
+    return;
+  creature->setBoardLocation(location(battle, player, slot));
+  markIfDead(creature);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// Removes a card from the field zone
+/// Adds the slot of a creature to the dying slots if its health dropped to 0 or below
 ///
-/// @param player player number
-/// @param slot slot number
+/// @param creature creature whose health changed, creatures that are not on the board are ignored
 ///
 /// @return nothing
-void Board::removeCardFromField(int player, int slot)
+void Board::markIfDead(const Creature *creature)
 {
-  field_zone_[player - 1][slot] = nullptr;
+  if (creature->isDead() && creature->getBoardLocation() >= 0)
+    dying_ |= 1u << creature->getBoardLocation();
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// Checks if all fields are full
+/// Changes the current health of a creature. Fights, traits and spells change health only through here,
+/// so a creature that dies on the board is added to the dying slots without looking at every slot.
 ///
-/// @param player player number
+/// @param creature creature on the board, or one that is not placed yet
+/// @param health new current health
 ///
-/// @return true = all fields full, false = some field is empty
-bool Board::areAllFieldsFull(int player)
+/// @return nothing
+void Board::setCreatureHealth(Creature *creature, int health)
 {
-  for (int i = 0; i < 7; i++)
-  {
-    if (field_zone_[player - 1][i] == nullptr)
-    {
-      return false;
-    }
-  }
-  return true;
+  creature->setCurrentHealth(health);
+  markIfDead(creature);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// Hands over the dying slots and clears them. Bit location(battle, player, slot) is set for a slot that
+/// may hold a dead creature; the battle zones come first, so the bits in ascending order are the order in
+/// which the dead creatures go to the graveyard.
+///
+/// @return dying slots
+uint32_t Board::takeDyingLocations()
+{
+  uint32_t dying = dying_;
+  dying_ = 0;
+  return dying;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// Damage dealt to creatures with Trait::P
+/// Finds the first free slot of a field zone
 ///
 /// @param player player number
-/// @param message according message
 ///
-/// @return nothing
-void Board::damagePoisonedCreatures(int player, std::string message)
+/// @return slot, -1 = all fields full
+int Board::findFreeFieldSlot(int player) const
 {
-  for (int slot = 0; slot < 7; slot++)
-  {
-    if (field_zone_[player - 1][slot] != nullptr)
-    {
-      if (field_zone_[player - 1][slot]->checkTrait(Trait::P))
-      {
-        field_zone_[player - 1][slot]->damageCreature(1);
-        std::cout << message << std::endl;
-      }
-    }
-    if (battle_zone_[player - 1][slot] != nullptr)
-    {
-      if (battle_zone_[player - 1][slot]->checkTrait(Trait::P))
-      {
-        battle_zone_[player - 1][slot]->damageCreature(1);
-        std::cout << message << std::endl;
-      }
-    }
-  }
+  int slot = std::countr_one(field_occupied_[player - 1]);
+  return slot < BOARD_SLOTS ? slot : -1;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
-/// Regenerate creatures with Trait::R
+/// Sets the occupancy bits of a slot in both zones of a player to what the zones hold
 ///
-/// @param player player number
-/// @param message according message
+/// @param player player index (0 or 1)
+/// @param slot slot
 ///
 /// @return nothing
-void Board::regenerateCreatures(int player, std::string message)
+void Board::updateOccupancy(int player, int slot)
 {
-  int status;
-  for (int slot = 0; slot < 7; slot++)
-  {
-    if (field_zone_[player - 1][slot] != nullptr)
-    {
-      if (field_zone_[player - 1][slot]->checkTrait(Trait::R))
-      {
-        status = field_zone_[player - 1][slot]->resetHealth();
-        if (status)
-          std::cout << message << std::endl;
-      }
-    }
-    if (battle_zone_[player - 1][slot] != nullptr)
-    {
-      if (battle_zone_[player - 1][slot]->checkTrait(Trait::R))
-      {
-        status = battle_zone_[player - 1][slot]->resetHealth();
-        if (status)
-          std::cout << message << std::endl;
-      }
-    }
-  }
+  uint8_t bit = static_cast<uint8_t>(1u << slot);
+  field_occupied_[player] =
+      static_cast<uint8_t>((field_occupied_[player] & ~bit) | (field_zone_[player][slot] ? bit : 0));
+  battle_occupied_[player] =
+      static_cast<uint8_t>((battle_occupied_[player] & ~bit) | (battle_zone_[player][slot] ? bit : 0));
 }
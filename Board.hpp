@@ -7,32 +7,52 @@
 #include "Player.hpp"
 #include "Creature.hpp"
 
+#define BOARD_SLOTS 7
+#define BOARD_FIELD_LOCATION 14
+#define BOARD_FULL_ZONE 0x7F
+
 class Board
 {
 protected:
   std::vector<std::shared_ptr<Creature>> field_zone_[2];
   std::vector<std::shared_ptr<Creature>> battle_zone_[2];
   bool is_active_;
+  uint32_t dying_;
+  uint8_t field_occupied_[2];
+  uint8_t battle_occupied_[2];
+
+  void setLocation(Creature *creature, bool battle, int player, int slot);
+  void updateOccupancy(int player, int slot);
+  void markIfDead(const Creature *creature);
 
 public:
   // Forward declarations
   Board();
   ~Board();
 
-  void printBoard(int defender, std::string border_A, std::string border_B) const;
+  void printBoard(int defender, std::string border_A, std::string border_B, std::ostream &out) const;
   void placeCardInBattle(std::shared_ptr<Creature> card, int player, int battle_slot, int field_pos);
-  bool isFieldSlotOccupied(int player, int slot) const;
-  bool isBattleSlotOccupied(int player, int slot) const;
-  bool areAllFieldsFull(int player);
-  void damagePoisonedCreatures(int player, std::string message);
-  void regenerateCreatures(int player, std::string message);
+  void moveCardToBattle(int player, int field_pos, int battle_pos);
+  bool isFieldSlotOccupied(int player, int slot) const { return field_occupied_[player - 1] & (1u << slot); }
+  bool isBattleSlotOccupied(int player, int slot) const { return battle_occupied_[player - 1] & (1u << slot); }
+  bool areAllFieldsFull(int player) const { return field_occupied_[player - 1] == BOARD_FULL_ZONE; }
+  int findFreeFieldSlot(int player) const;
+  uint8_t getFieldOccupancy(int player) const { return field_occupied_[player - 1]; }
+  uint8_t getBattleOccupancy(int player) const { return battle_occupied_[player - 1]; }
   void placeCard(std::shared_ptr<Creature> card, int player, int fieldSlot);
   void toggleActive() { is_active_ = !is_active_; };
   bool isActive() const { return is_active_; };
-  std::shared_ptr<Creature> fetchBattleCard(int player, int slot);
-  std::shared_ptr<Creature> fetchFieldCard(int player, int slot);
-  void removeCardFromBattle(int player, int slot);
-  void removeCardFromField(int player, int slot);
+  Creature *fetchBattleCard(int player, int slot) const { return battle_zone_[player - 1][slot].get(); }
+  Creature *fetchFieldCard(int player, int slot) const { return field_zone_[player - 1][slot].get(); }
+  std::shared_ptr<Creature> shareBattleCard(int player, int slot) const { return battle_zone_[player - 1][slot]; }
+  std::shared_ptr<Creature> shareFieldCard(int player, int slot) const { return field_zone_[player - 1][slot]; }
+  std::shared_ptr<Creature> takeBattleCard(int player, int slot);
+  std::shared_ptr<Creature> takeFieldCard(int player, int slot);
+  void detachCards(const std::shared_ptr<CardArena> &arena);
+  void setCreatureHealth(Creature *creature, int health);
+  void damageCreature(Creature *creature, int damage) { setCreatureHealth(creature, creature->getCurrentHealth() - damage); }
+  uint32_t takeDyingLocations();
+  static int location(bool battle, int player, int slot) { return (battle ? 0 : BOARD_FIELD_LOCATION) + player * BOARD_SLOTS + slot; }
 };
 
 #endif
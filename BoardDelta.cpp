@@ -0,0 +1,178 @@
+#include <cstring>
+
+#include "BoardDelta.hpp"
+#include "Game.hpp"
+#include "Creature.hpp"
+
+#define BOARD_DELTA_TRAIT_LETTERS "BCFHLPRTUV"
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Copies a slot of the board
+///
+/// @param creature creature in the slot, nullptr = empty slot
+///
+/// @return view of the slot
+static SlotView viewSlot(const Creature *creature)
+{
+  SlotView slot;
+  if (!creature)
+    return slot;
+  std::strncpy(slot.id, creature->getCardID().c_str(), BOARD_DELTA_ID_LENGTH - 1);
+  slot.attack = static_cast<int16_t>(creature->getCurrentAttack());
+  slot.health = static_cast<int16_t>(creature->getCurrentHealth());
+  slot.traits = creature->getTraitMask();
+  return slot;
+}
+
+static bool sameSlot(const SlotView &first, const SlotView &second)
+{
+  return first.attack == second.attack && first.health == second.health && first.traits == second.traits &&
+         std::strncmp(first.id, second.id, BOARD_DELTA_ID_LENGTH) == 0;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Appends the traits of a slot as letters, '-' = no traits
+///
+/// @param traits trait mask
+/// @param text text to append to
+///
+/// @return nothing
+static void appendTraits(uint16_t traits, std::string &text)
+{
+  size_t length = text.size();
+  for (int trait = Trait::B; trait <= Trait::V; trait++)
+  {
+    if (traits & traitBit(static_cast<Trait>(trait)))
+      text.push_back(BOARD_DELTA_TRAIT_LETTERS[trait - Trait::B]);
+  }
+  if (text.size() == length)
+    text.push_back('-');
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Appends the changes of one slot: S = new card, A = new stats, T = new traits, E = emptied
+///
+/// @param prefix player, zone and slot, e.g. "1 B 3"
+/// @param current slot now
+/// @param previous slot before
+/// @param text text to append to
+///
+/// @return nothing
+static void appendSlot(const std::string &prefix, const SlotView &current, const SlotView &previous,
+                       std::string &text)
+{
+  if (current.isEmpty())
+  {
+    if (!previous.isEmpty())
+      text += "E " + prefix + "\n";
+    return;
+  }
+
+  std::string stats = std::to_string(current.attack) + " " + std::to_string(current.health);
+  if (std::strncmp(current.id, previous.id, BOARD_DELTA_ID_LENGTH) != 0)
+  {
+    text += "S " + prefix + " " + current.id + " " + stats + " ";
+    appendTraits(current.traits, text);
+    text.push_back('\n');
+    return;
+  }
+  if (current.attack != previous.attack || current.health != previous.health)
+    text += "A " + prefix + " " + stats + "\n";
+  if (current.traits != previous.traits)
+  {
+    text += "T " + prefix + " ";
+    appendTraits(current.traits, text);
+    text.push_back('\n');
+  }
+}
+
+BoardView::BoardView() : round_(0), attacker_(0), active_player_(0), health_{0, 0}, mana_{0, 0} {}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Copies what a spectator sees of a game
+///
+/// @param game game to copy
+///
+/// @return nothing
+BoardView::BoardView(const Game &game)
+    : round_(game.getRound()), attacker_(game.getAttackerNumber()), active_player_(game.getActivePlayerNumber())
+{
+  const Board &board = game.getBoard();
+  for (int player = 1; player <= 2; player++)
+  {
+    health_[player - 1] = game.getPlayer(player).getHealth();
+    mana_[player - 1] = game.getPlayer(player).getMana();
+    for (int slot = 0; slot < BOARD_DELTA_SLOTS; slot++)
+    {
+      field_[player - 1][slot] = viewSlot(board.fetchFieldCard(player, slot));
+      battle_[player - 1][slot] = viewSlot(board.fetchBattleCard(player, slot));
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Appends the lines that turn the previous view into this one, followed by the end line '.'
+///
+/// @param previous view the spectator has
+/// @param keyframe true = write round and players even if unchanged
+/// @param text text to append to, unchanged if nothing changed
+///
+/// @return nothing
+void BoardView::appendChanges(const BoardView &previous, bool keyframe, std::string &text) const
+{
+  size_t length = text.size();
+  if (keyframe || round_ != previous.round_ || attacker_ != previous.attacker_ ||
+      active_player_ != previous.active_player_)
+    text += "R " + std::to_string(round_) + " " + std::to_string(attacker_) + " " +
+            std::to_string(active_player_) + "\n";
+
+  for (int player = 0; player < 2; player++)
+  {
+    if (keyframe || health_[player] != previous.health_[player] || mana_[player] != previous.mana_[player])
+      text += "P " + std::to_string(player + 1) + " " + std::to_string(health_[player]) + " " +
+              std::to_string(mana_[player]) + "\n";
+    for (int slot = 0; slot < BOARD_DELTA_SLOTS; slot++)
+    {
+      if (!sameSlot(field_[player][slot], previous.field_[player][slot]))
+        appendSlot(std::to_string(player + 1) + " F " + std::to_string(slot + 1), field_[player][slot],
+                   previous.field_[player][slot], text);
+      if (!sameSlot(battle_[player][slot], previous.battle_[player][slot]))
+        appendSlot(std::to_string(player + 1) + " B " + std::to_string(slot + 1), battle_[player][slot],
+                   previous.battle_[player][slot], text);
+    }
+  }
+
+  if (keyframe || text.size() != length)
+    text += ".\n";
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Encodes the whole view for a spectator that starts watching or has fallen behind
+///
+/// @return K line, the round, both players, the occupied slots and the end line
+std::string BoardView::encodeKeyframe() const
+{
+  std::string text = "K\n";
+  appendChanges(BoardView(), true, text);
+  return text;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Encodes what changed since the previous view
+///
+/// @param previous view before the action
+///
+/// @return changed lines and the end line, empty = nothing changed
+std::string BoardView::encodeDelta(const BoardView &previous) const
+{
+  std::string text;
+  appendChanges(previous, false, text);
+  return text;
+}
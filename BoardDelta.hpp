@@ -0,0 +1,57 @@
+#ifndef BOARDDELTA_HPP
+#define BOARDDELTA_HPP
+
+#include <string>
+#include <cstdint>
+
+#define BOARD_DELTA_SLOTS 7
+#define BOARD_DELTA_ID_LENGTH 8
+
+class Game;
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// What a spectator sees of one slot: the card ID, the current stats and the traits. An empty ID is an
+/// empty slot.
+///
+struct SlotView
+{
+  char id[BOARD_DELTA_ID_LENGTH] = {};
+  int16_t attack = 0;
+  int16_t health = 0;
+  uint16_t traits = 0;
+
+  bool isEmpty() const { return !id[0]; }
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Plain copy of everything a spectator sees of a game: round, attacker, active player, health and mana
+/// of both players and the slots of both fields and battle zones. Views are compared to send only what
+/// an action changed; the text format of the changes is described in the README.
+///
+class BoardView
+{
+protected:
+  int round_;
+  int attacker_;
+  int active_player_;
+  int health_[2];
+  int mana_[2];
+  SlotView field_[2][BOARD_DELTA_SLOTS];
+  SlotView battle_[2][BOARD_DELTA_SLOTS];
+
+  void appendChanges(const BoardView &previous, bool keyframe, std::string &text) const;
+
+public:
+  // Forward declarations
+  BoardView();
+  explicit BoardView(const Game &game);
+  ~BoardView() = default;
+
+  std::string encodeKeyframe() const;
+  std::string encodeDelta(const BoardView &previous) const;
+  int getRound() const { return round_; }
+};
+
+#endif
@@ -0,0 +1,393 @@
+#include <cmath>
+#include <algorithm>
+
+#include "Bot.hpp"
+#include "Game.hpp"
+#include "Solver.hpp"
+#include "JobScheduler.hpp"
+
+Bot::Bot(int player, std::chrono::milliseconds think_time, std::shared_ptr<SolveTable> table, uint64_t seed)
+    : player_(player), think_time_(think_time), table_(table), seed_generator_(seed),
+      last_sample_count_(0), ponder_stop_(false),
+      cancelled_(false)
+{
+  thread_count_ = JobScheduler::shared().getConcurrency();
+}
+
+Bot::~Bot()
+{
+  stopPondering();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Chooses the next action of the bot. Samples are searched on all cores until the think time is used
+/// up, so the number of samples adapts to the time budget. A call to cancel from another thread stops
+/// the search early, the returned action is meaningless then.
+///
+/// @param game current game, the bot only uses the information its player can see
+///
+/// @return action to play
+Command Bot::chooseAction(const Game &game)
+{
+  stopPondering();
+  std::vector<Command> actions = game.generateActions();
+  last_sample_count_ = 0;
+  if (actions.size() == 1)
+    return actions.front();
+
+  Command book_action(CommandType::INVALID);
+  if (book_ && book_->lookup(game.positionHash(), book_action))
+  {
+    for (const Command &action : actions)
+    {
+      if (action.toString() == book_action.toString())
+        return action;
+    }
+  }
+
+  std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + think_time_;
+  std::vector<std::vector<ActionStatistics>> statistics(thread_count_,
+                                                        std::vector<ActionStatistics>(actions.size(), {0.0, 0}));
+  JobGroup samplers;
+  for (unsigned int worker = 0; worker < thread_count_; worker++)
+  {
+    uint64_t seed = seed_generator_();
+    std::vector<ActionStatistics> *worker_statistics = &statistics[worker];
+    samplers.run([this, &game, deadline, seed, worker_statistics]
+                 { sampleWorker(game, deadline, seed, *worker_statistics); });
+  }
+  samplers.wait();
+
+  // samples pondered while the opponent was thinking count like the ones searched now
+  std::vector<ActionStatistics> total(actions.size(), {0.0, 0});
+  {
+    std::lock_guard<std::mutex> lock(ponder_mutex_);
+    auto pondered = ponder_cache_.find(game.visibleHash(player_));
+    if (pondered != ponder_cache_.end() && pondered->second.size() == actions.size())
+      total = pondered->second;
+    ponder_cache_.clear();
+  }
+  for (const auto &worker_statistics : statistics)
+  {
+    for (unsigned long index = 0; index < actions.size(); index++)
+    {
+      total[index].value_sum += worker_statistics[index].value_sum;
+      total[index].samples += worker_statistics[index].samples;
+    }
+  }
+
+  if (cancelled_)
+    return actions.front();
+
+  // no sample finished in time: fall back to the plain evaluation of a single sample
+  if (total.front().samples == 0)
+  {
+    Game sample(game);
+    sample.setOutputStream(nullptr);
+    sample.determinize(player_, seed_generator_);
+    for (unsigned long index = 0; index < actions.size(); index++)
+    {
+      total[index] = {sampleValue(sample, actions[index], Outcome::UNKNOWN), 1};
+    }
+  }
+
+  last_sample_count_ = total.front().samples;
+  unsigned long best = 0;
+  for (unsigned long index = 1; index < actions.size(); index++)
+  {
+    if (total[index].value_sum / total[index].samples > total[best].value_sum / total[best].samples)
+      best = index;
+  }
+  return actions[best];
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Searches one sample of the game and adds the action values to the statistics
+///
+/// @param game current game
+/// @param generator random number generator used to sample the hidden cards
+/// @param solver solver of the calling thread
+/// @param statistics summed up action values, one entry per legal action
+///
+/// @return true = sample added, false = search was interrupted before the sample was finished
+bool Bot::searchSample(const Game &game, std::mt19937_64 &generator, Solver &solver,
+                       std::vector<ActionStatistics> &statistics) const
+{
+  Game sample(game);
+  sample.setOutputStream(nullptr);
+  sample.determinize(player_, generator);
+
+  std::vector<ActionValue> values = solver.evaluateActions(sample);
+  if (solver.wasInterrupted() || values.size() != statistics.size())
+    return false;
+
+  for (unsigned long index = 0; index < values.size(); index++)
+  {
+    statistics[index].value_sum += sampleValue(sample, values[index].action, values[index].outcome);
+    statistics[index].samples++;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Searches samples of the game until the deadline is reached. Runs as a job of the shared scheduler.
+///
+/// @param game current game
+/// @param deadline time at which the bot has to decide
+/// @param seed seed of this worker's random number generator
+/// @param statistics summed up action values of this worker, one entry per legal action
+///
+/// @return nothing
+void Bot::sampleWorker(const Game &game, std::chrono::steady_clock::time_point deadline, uint64_t seed,
+                       std::vector<ActionStatistics> &statistics)
+{
+  std::mt19937_64 generator(seed);
+  Solver solver(table_.get(), BOT_SAMPLE_NODE_LIMIT);
+  solver.setDeadline(deadline);
+  solver.setCancelFlag(&cancelled_);
+
+  while (searchSample(game, generator, solver, statistics))
+  {
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Starts searching in the background while the opponent is to move. Stops pondering that is still
+/// running first.
+///
+/// @param game current game, the opponent of the bot is to move
+///
+/// @return nothing
+void Bot::startPondering(const Game &game)
+{
+  stopPondering();
+  uint64_t sample_seed = seed_generator_();
+  std::vector<uint64_t> seeds;
+  for (unsigned int worker = 0; worker < thread_count_; worker++)
+  {
+    seeds.push_back(seed_generator_());
+  }
+  ponder_stop_ = false;
+  ponder_thread_ = std::thread(&Bot::ponder, this, game, sample_seed, seeds);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Stops background searching, the samples found so far are kept for chooseAction
+///
+/// @return nothing
+void Bot::stopPondering()
+{
+  if (!ponder_thread_.joinable())
+    return;
+  ponder_stop_ = true;
+  ponder_thread_.join();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Ponders the positions the bot expects to face after the opponent's turn. The opponent's turn is
+/// predicted in a sample of the hidden cards, so the predictions only use what the bot can see. Runs on
+/// its own thread until stopPondering is called.
+///
+/// @param game current game
+/// @param sample_seed seed of the sample the opponent's turn is predicted in
+/// @param seeds one random seed per worker job
+///
+/// @return nothing
+void Bot::ponder(Game game, uint64_t sample_seed, std::vector<uint64_t> seeds)
+{
+  game.setOutputStream(nullptr);
+  std::mt19937_64 generator(sample_seed);
+  game.determinize(player_, generator);
+  std::vector<Game> positions = predictPositions(game);
+  if (positions.empty())
+    return;
+
+  std::vector<std::vector<std::vector<ActionStatistics>>> statistics(seeds.size());
+  for (unsigned long worker = 0; worker < seeds.size(); worker++)
+  {
+    for (const Game &position : positions)
+    {
+      statistics[worker].emplace_back(position.generateActions().size(), ActionStatistics{0.0, 0});
+    }
+  }
+  JobGroup ponderers;
+  for (unsigned long worker = 0; worker < seeds.size(); worker++)
+  {
+    uint64_t seed = seeds[worker];
+    std::vector<std::vector<ActionStatistics>> *worker_statistics = &statistics[worker];
+    ponderers.run([this, &positions, seed, worker_statistics]
+                  { ponderWorker(positions, seed, *worker_statistics); });
+  }
+  ponderers.wait();
+
+  std::lock_guard<std::mutex> lock(ponder_mutex_);
+  if (ponder_cache_.size() + positions.size() > BOT_PONDER_CACHE_LIMIT)
+    ponder_cache_.clear();
+  for (unsigned long index = 0; index < positions.size(); index++)
+  {
+    std::vector<ActionStatistics> &cached = ponder_cache_[positions[index].visibleHash(player_)];
+    if (cached.size() != statistics.front()[index].size())
+      cached.assign(statistics.front()[index].size(), {0.0, 0});
+    for (const auto &worker_statistics : statistics)
+    {
+      for (unsigned long action = 0; action < cached.size(); action++)
+      {
+        cached[action].value_sum += worker_statistics[index][action].value_sum;
+        cached[action].samples += worker_statistics[index][action].samples;
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Searches samples of the predicted positions until pondering is stopped, more likely positions get
+/// more samples. Runs as a job of the shared scheduler.
+///
+/// @param positions predicted positions, the bot is to move in all of them
+/// @param seed seed of this worker's random number generator
+/// @param statistics summed up action values of this worker, one list per position
+///
+/// @return nothing
+void Bot::ponderWorker(const std::vector<Game> &positions, uint64_t seed,
+                       std::vector<std::vector<ActionStatistics>> &statistics)
+{
+  std::mt19937_64 generator(seed);
+  Solver solver(table_.get(), BOT_SAMPLE_NODE_LIMIT);
+  solver.setCancelFlag(&ponder_stop_);
+
+  // the first position gets every second sample, the next one every fourth and so on
+  for (unsigned long turn = 1; !ponder_stop_; turn++)
+  {
+    unsigned long index = 0;
+    while (index + 1 < positions.size() && (turn >> index & 1) == 0)
+      index++;
+    searchSample(positions[index], generator, solver, statistics[index]);
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Predicts the positions in which the bot has to decide next. Every action of the opponent is
+/// followed by the opponent playing greedily on the position evaluation until the bot is to move. The
+/// line of the opponent finishing the phase comes first, then the lines with the best first action.
+/// The positions are told apart by what the bot can see of them, the hash the pondered samples are
+/// cached under.
+///
+/// @param game sample of the current game, the opponent of the bot is to move
+///
+/// @return up to BOT_PONDER_MAX_POSITIONS different positions, most likely first
+std::vector<Game> Bot::predictPositions(const Game &game) const
+{
+  double sign = player_ == 1 ? -1.0 : 1.0;
+  std::vector<std::pair<double, std::unique_ptr<Game>>> lines;
+  for (const Command &action : game.generateActions())
+  {
+    std::unique_ptr<Game> position = std::make_unique<Game>(game);
+    position->setOutputStream(nullptr);
+    int game_status = position->applyAction(action);
+    // finishing the phase right away is always considered, it is the most common human reply
+    double value = action.isDone() ? 2.0 : sign * evaluatePosition(*position);
+
+    // the opponent's phase ends with done at the latest, so the line reaches the bot within a few steps
+    for (int step = 0; !game_status && position->getActivePlayerNumber() != player_ && step < BOT_PONDER_MAX_STEPS;
+         step++)
+    {
+      std::unique_ptr<Game> best = nullptr;
+      double best_value = 0.0;
+      for (const Command &reply : position->generateActions())
+      {
+        std::unique_ptr<Game> next = std::make_unique<Game>(*position);
+        next->setOutputStream(nullptr);
+        int next_status = next->applyAction(reply);
+        double next_value = sign * evaluatePosition(*next);
+        if (!next_status && next->positionHash() != position->positionHash() && (!best || next_value > best_value))
+        {
+          best = std::move(next);
+          best_value = next_value;
+        }
+      }
+      if (!best)
+        break;
+      position = std::move(best);
+    }
+    if (!game_status && position->getActivePlayerNumber() == player_)
+      lines.emplace_back(value, std::move(position));
+  }
+
+  std::stable_sort(lines.begin(), lines.end(),
+                   [](const std::pair<double, std::unique_ptr<Game>> &first,
+                      const std::pair<double, std::unique_ptr<Game>> &second)
+                   { return first.first > second.first; });
+
+  std::vector<Game> positions;
+  std::vector<uint64_t> hashes;
+  for (const auto &line : lines)
+  {
+    uint64_t hash = line.second->visibleHash(player_);
+    if (positions.size() >= BOT_PONDER_MAX_POSITIONS ||
+        std::find(hashes.begin(), hashes.end(), hash) != hashes.end() ||
+        line.second->generateActions().size() < 2)
+      continue;
+    hashes.push_back(hash);
+    positions.push_back(*line.second);
+  }
+  return positions;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Value of an action in one sample, seen from the bot
+///
+/// @param sample sampled game
+/// @param action action that was searched
+/// @param outcome solved outcome of the action, Outcome::UNKNOWN = use the position evaluation
+///
+/// @return value around -1 (bot loses) to 1 (bot wins)
+double Bot::sampleValue(const Game &sample, const Command &action, Outcome outcome) const
+{
+  Game child(sample);
+  child.setOutputStream(nullptr);
+  int game_status = child.applyAction(action);
+  if (game_status)
+    outcome = Solver::outcomeFromStatus(game_status);
+
+  // solved actions always rank above unsolved ones, the evaluation only breaks ties between them
+  double value = 0.9 * evaluatePosition(child);
+  if (outcome != Outcome::UNKNOWN)
+    value = Solver::valueFromOutcome(outcome) + 0.01 * evaluatePosition(child);
+  return player_ == 1 ? value : -value;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Estimates who is ahead in an unsolved position, from the health difference and the creatures on
+/// the board
+///
+/// @param game position to evaluate
+///
+/// @return value between -1 (player 2 is winning) and 1 (player 1 is winning)
+double Bot::evaluatePosition(const Game &game)
+{
+  double score = game.getPlayer(1).getHealth() - game.getPlayer(2).getHealth();
+  for (int player = 1; player <= 2; player++)
+  {
+    double sign = player == 1 ? 1.0 : -1.0;
+    for (int slot = 0; slot < 7; slot++)
+    {
+      const Creature *creature = game.getBoard().fetchFieldCard(player, slot);
+      if (creature != nullptr)
+        score += sign * 0.1 * (creature->getCurrentAttack() + creature->getCurrentHealth());
+      creature = game.getBoard().fetchBattleCard(player, slot);
+      if (creature != nullptr)
+        score += sign * 0.1 * (creature->getCurrentAttack() + creature->getCurrentHealth());
+    }
+  }
+  return std::tanh(score / 4.0);
+}
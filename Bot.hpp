@@ -0,0 +1,87 @@
+#ifndef BOT_HPP
+#define BOT_HPP
+
+#include <vector>
+#include <memory>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+
+#include "Command.hpp"
+#include "SolveTable.hpp"
+#include "OpeningBook.hpp"
+
+#define BOT_DEFAULT_THINK_TIME_MS 1000
+#define BOT_SAMPLE_NODE_LIMIT 20000
+#define BOT_PONDER_MAX_POSITIONS 8
+#define BOT_PONDER_CACHE_LIMIT 64
+#define BOT_PONDER_MAX_STEPS 32
+
+class Game;
+class Solver;
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Computer player that does not look at hidden information. It uses perfect information Monte Carlo
+/// search: the opponent's hand and deck and its own deck order are sampled many times, every sample is
+/// searched with the Solver and the action values are averaged over all samples. Positions found in the
+/// opening book are answered without searching. While the opponent is thinking, the bot can ponder the
+/// positions it expects to face next and reuses those samples when one of them is reached.
+///
+class Bot
+{
+protected:
+  struct ActionStatistics
+  {
+    double value_sum;
+    unsigned long samples;
+  };
+
+  int player_;
+  std::chrono::milliseconds think_time_;
+  unsigned int thread_count_;
+  std::shared_ptr<SolveTable> table_;
+  std::shared_ptr<const OpeningBook> book_;
+  std::mt19937_64 seed_generator_;
+  unsigned long last_sample_count_;
+  std::thread ponder_thread_;
+  std::atomic<bool> ponder_stop_;
+  std::atomic<bool> cancelled_;
+  std::mutex ponder_mutex_;
+  std::unordered_map<uint64_t, std::vector<ActionStatistics>> ponder_cache_;
+
+  bool searchSample(const Game &game, std::mt19937_64 &generator, Solver &solver,
+                    std::vector<ActionStatistics> &statistics) const;
+  void sampleWorker(const Game &game, std::chrono::steady_clock::time_point deadline, uint64_t seed,
+                    std::vector<ActionStatistics> &statistics);
+  void ponder(Game game, uint64_t sample_seed, std::vector<uint64_t> seeds);
+  void ponderWorker(const std::vector<Game> &positions, uint64_t seed,
+                    std::vector<std::vector<ActionStatistics>> &statistics);
+  std::vector<Game> predictPositions(const Game &game) const;
+  double sampleValue(const Game &sample, const Command &action, Outcome outcome) const;
+
+public:
+  // Forward declarations
+  Bot(int player, std::chrono::milliseconds think_time, std::shared_ptr<SolveTable> table,
+      uint64_t seed = std::random_device{}());
+  Bot(const Bot &) = delete;
+  ~Bot();
+
+  Command chooseAction(const Game &game);
+  void cancel() { cancelled_ = true; }
+  void resetCancel() { cancelled_ = false; }
+  bool wasCancelled() const { return cancelled_; }
+  void startPondering(const Game &game);
+  void stopPondering();
+  void setOpeningBook(std::shared_ptr<const OpeningBook> book) { book_ = book; }
+  int getPlayerNumber() const { return player_; }
+  unsigned long getLastSampleCount() const { return last_sample_count_; }
+
+  static double evaluatePosition(const Game &game);
+};
+
+#endif
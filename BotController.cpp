@@ -0,0 +1,67 @@
+#include <iostream>
+
+#include "BotController.hpp"
+
+BotController::BotController(std::unique_ptr<Bot> bot) : bot_(std::move(bot)) {}
+
+BotController::~BotController()
+{
+  cancel();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Starts searching the next action on a worker thread. The bot searches its own copy of the game, so
+/// the caller's game stays untouched.
+///
+/// @param game current game, the bot is to move
+///
+/// @return nothing
+void BotController::startTurn(const Game &game)
+{
+  cancel();
+  game_ = std::make_unique<Game>(game);
+  game_->setOutputStream(nullptr);
+  bot_->resetCancel();
+  action_ = std::async(std::launch::async, [this]() { return bot_->chooseAction(*game_); });
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Waits until the bot has decided or the timeout has passed
+///
+/// @param timeout maximum time to wait
+///
+/// @return true = action can be taken, false = bot is still searching
+bool BotController::waitForAction(std::chrono::milliseconds timeout)
+{
+  return action_.wait_for(timeout) == std::future_status::ready;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Takes the action the bot has decided on and prints it like a command entered at the prompt. Waits
+/// for the search if it is not finished yet.
+///
+/// @return decided action
+Command BotController::takeAction()
+{
+  Command action = action_.get();
+  std::cout << std::endl
+            << "P" << bot_->getPlayerNumber() << "> " << action.toString() << std::endl;
+  return action;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Stops a running search and waits for the worker thread, the result is dropped
+///
+/// @return nothing
+void BotController::cancel()
+{
+  if (!action_.valid())
+    return;
+  bot_->cancel();
+  action_.wait();
+  action_ = std::future<Command>();
+}
@@ -0,0 +1,36 @@
+#ifndef BOTCONTROLLER_HPP
+#define BOTCONTROLLER_HPP
+
+#include <memory>
+#include <future>
+
+#include "PlayerController.hpp"
+#include "Bot.hpp"
+#include "Game.hpp"
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Computer player whose search runs on a worker thread. The search stops at the bot's think time or
+/// as soon as the turn is cancelled.
+///
+class BotController : public PlayerController
+{
+protected:
+  std::unique_ptr<Bot> bot_;
+  std::unique_ptr<Game> game_;
+  std::future<Command> action_;
+
+public:
+  // Forward declarations
+  explicit BotController(std::unique_ptr<Bot> bot);
+  ~BotController() override;
+
+  void startTurn(const Game &game) override;
+  bool waitForAction(std::chrono::milliseconds timeout) override;
+  Command takeAction() override;
+  void cancel() override;
+  void startPondering(const Game &game) override { bot_->startPondering(game); }
+  void stopPondering() override { bot_->stopPondering(); }
+};
+
+#endif
@@ -6,30 +6,21 @@
 #include <string>
 #include <memory>
 
+#include "CardArena.hpp"
+
 class Card
 {
-protected:
-  std::string name_;
-  std::string ID_;
-  std::string effect = "";
-
 public:
   // Forward declarations
-  Card();
-  Card(std::string name, std::string ID);
+  Card() = default;
   virtual ~Card() = default;
 
-  virtual void printInfo(std::string border_info, std::string border_d) = 0;
-  static std::shared_ptr<Card> createCardFromID(const std::string &ID);
+  virtual void printInfo(std::string border_info, std::string border_d, std::ostream &out) = 0;
+  static std::shared_ptr<Card> createCardFromID(const std::string &ID, const std::shared_ptr<CardArena> &arena = nullptr);
   virtual std::vector<std::string> printCard() const;
 
-  void changeEffect(std::string new_effect);
-
-  void setCardID(std::string ID) { ID_ = ID; }
-  void setCardName(std::string name) { name_ = name; }
-
-  std::string getCardID() const { return ID_; }
-  std::string getCardName() const { return name_; }
+  virtual const std::string &getCardID() const = 0;
+  virtual const std::string &getCardName() const = 0;
 };
 
 #endif
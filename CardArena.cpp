@@ -0,0 +1,34 @@
+#include <vector>
+
+#include "CardArena.hpp"
+
+// buffers of released arenas, kept by the thread that released them
+static thread_local std::vector<std::unique_ptr<std::byte[]>> free_buffers;
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Takes a buffer released by an earlier arena of this thread, or allocates a new one
+///
+/// @return buffer of CARD_ARENA_SIZE bytes
+std::unique_ptr<std::byte[]> CardArena::takeBuffer()
+{
+  if (free_buffers.empty())
+    return std::unique_ptr<std::byte[]>(new std::byte[CARD_ARENA_SIZE]);
+  std::unique_ptr<std::byte[]> buffer = std::move(free_buffers.back());
+  free_buffers.pop_back();
+  return buffer;
+}
+
+CardArena::CardArena() : buffer_(takeBuffer()), resource_(buffer_.get(), CARD_ARENA_SIZE) {}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Releases all blocks taken from the heap and keeps the buffer for the next arena of this thread
+///
+/// @return nothing
+CardArena::~CardArena()
+{
+  resource_.release();
+  if (free_buffers.size() < CARD_ARENA_POOL_LIMIT)
+    free_buffers.push_back(std::move(buffer_));
+}
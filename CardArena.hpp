@@ -0,0 +1,84 @@
+#ifndef CARDARENA_HPP
+#define CARDARENA_HPP
+
+#include <memory>
+#include <memory_resource>
+#include <cstddef>
+
+#define CARD_ARENA_SIZE 16384
+#define CARD_ARENA_POOL_LIMIT 64
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Memory for the creatures of one game. Creatures are placed one after another in a buffer of fixed
+/// size; only games that outgrow it take more blocks from the heap. Nothing is freed card by card, all
+/// memory is released in one step with the arena, so it has to outlive every creature created in it.
+/// Released buffers are kept per thread for the next arena, so the many short-lived game copies of the
+/// search do not touch the heap for their creatures. Not thread-safe: the creatures of an arena are
+/// only created by the thread that plays its game.
+///
+class CardArena
+{
+protected:
+  std::unique_ptr<std::byte[]> buffer_;
+  std::pmr::monotonic_buffer_resource resource_;
+
+  static std::unique_ptr<std::byte[]> takeBuffer();
+
+public:
+  // Forward declarations
+  CardArena();
+  CardArena(const CardArena &) = delete;
+  ~CardArena();
+
+  void *allocate(size_t bytes, size_t alignment) { return resource_.allocate(bytes, alignment); }
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Allocator for std::allocate_shared, it only refers to the arena, so creating and releasing a
+/// creature does not touch a reference count of the arena.
+///
+template <typename T>
+class ArenaAllocator
+{
+protected:
+  CardArena *arena_;
+
+  template <typename U>
+  friend class ArenaAllocator;
+
+public:
+  using value_type = T;
+
+  explicit ArenaAllocator(CardArena *arena) : arena_(arena) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U> &other) : arena_(other.arena_) {}
+
+  T *allocate(size_t count) { return static_cast<T *>(arena_->allocate(count * sizeof(T), alignof(T))); }
+  void deallocate(T *, size_t) {}
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U> &other) const { return arena_ == other.arena_; }
+  template <typename U>
+  bool operator!=(const ArenaAllocator<U> &other) const { return arena_ != other.arena_; }
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Creates a creature in an arena, or on the heap without one
+///
+/// @param arena arena of the game, nullptr = heap
+/// @param arguments constructor arguments of the creature
+///
+/// @return new creature
+template <typename CardType, typename... Arguments>
+std::shared_ptr<CardType> allocateCard(const std::shared_ptr<CardArena> &arena, Arguments &&...arguments)
+{
+  if (arena == nullptr)
+    return std::make_shared<CardType>(std::forward<Arguments>(arguments)...);
+  return std::allocate_shared<CardType>(ArenaAllocator<CardType>(arena.get()),
+                                        std::forward<Arguments>(arguments)...);
+}
+
+#endif
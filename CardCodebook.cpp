@@ -0,0 +1,335 @@
+#include <cstring>
+#include <fstream>
+#include <cstdio>
+#include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <unistd.h>
+
+#include "CardCodebook.hpp"
+#include "Exeption.hpp"
+#include "PrototypeTable.hpp"
+
+#define CARD_CODEBOOK_MAGIC "MOOPCARD"
+#define CARD_CODEBOOK_VERSION 2
+
+struct CardCodebookHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t creature_count;
+  uint64_t source_checksum;
+  uint64_t source_size;
+  uint32_t spell_count;
+  uint32_t string_table_size;
+};
+
+// checksum of the codebook whose cards were created last, 0 = none yet
+static std::atomic<uint64_t> loaded_checksum{0};
+
+struct CreatureRecord
+{
+  int32_t mana_cost;
+  int32_t attack;
+  int32_t health;
+  uint32_t id;
+  uint32_t name;
+  uint32_t traits;
+};
+
+struct SpellRecord
+{
+  int32_t mana_cost;
+  uint32_t id;
+  uint32_t name;
+  uint32_t effect;
+  SpellCost cost;
+  SpellTarget target;
+  uint8_t program_length;
+  SpellOp program[SPELL_PROGRAM_LENGTH];
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// FNV-1a checksum of the codebook text
+///
+/// @param text codebook text
+///
+/// @return 64 bit checksum
+static uint64_t checksumText(std::string_view text)
+{
+  uint64_t checksum = 14695981039346656037ULL;
+  for (unsigned char character : text)
+  {
+    checksum ^= character;
+    checksum *= 1099511628211ULL;
+  }
+  return checksum;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Cuts the next field of a codebook line
+///
+/// @param line rest of the line, the field and its ';' are removed from it
+///
+/// @return field, the whole rest of the line if there is no ';' left
+static std::string_view nextField(std::string_view &line)
+{
+  size_t pos = line.find(';');
+  std::string_view field = line.substr(0, pos);
+  line = pos == std::string_view::npos ? std::string_view() : line.substr(pos + 1);
+  return field;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Loads the codebook from its image file if the image matches the text file, otherwise compiles the
+/// text and writes a new image file. Throws a file_error if the text file cannot be read or a line of
+/// it is invalid.
+///
+/// @param text_file_name path to the codebook text file
+/// @param image_file_name path to the compiled image file
+///
+/// @return nothing
+CardCodebook::CardCodebook(const std::string &text_file_name, const std::string &image_file_name)
+    : image_(nullptr), image_size_(0), loaded_from_image_file_(false)
+{
+  MappedFile text_file(text_file_name, false);
+  std::string_view text(static_cast<const char *>(text_file.getData()), text_file.getSize());
+  uint64_t checksum = checksumText(text);
+
+  try
+  {
+    mapped_image_ = std::make_unique<MappedFile>(image_file_name, false);
+    if (isValidImage(static_cast<const char *>(mapped_image_->getData()), mapped_image_->getSize(), checksum,
+                     text.size()))
+    {
+      image_ = static_cast<const char *>(mapped_image_->getData());
+      image_size_ = mapped_image_->getSize();
+      loaded_from_image_file_ = true;
+      return;
+    }
+    mapped_image_.reset();
+  }
+  catch (const file_error &e)
+  {
+  }
+
+  try
+  {
+    compiled_image_ = compile(text, checksum);
+  }
+  catch (const std::logic_error &e)
+  {
+    throw file_error(text_file_name);
+  }
+  image_ = compiled_image_.data();
+  image_size_ = compiled_image_.size();
+  writeImage(image_file_name, compiled_image_);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Parses the codebook text in one pass and compiles it into an image. The creature section starts
+/// with the line "creature" and ends at the line "spell", which starts the spell section. The effect
+/// programs of the spells are compiled into the spell records. Throws std::logic_error for an invalid
+/// line.
+///
+/// @param text codebook text
+/// @param checksum checksum of the text
+///
+/// @return compiled image
+std::vector<char> CardCodebook::compile(std::string_view text, uint64_t checksum)
+{
+  std::vector<CreatureRecord> creatures;
+  std::vector<SpellRecord> spells;
+  std::string strings;
+  auto addString = [&strings](std::string_view string)
+  {
+    uint32_t offset = strings.size();
+    strings.append(string);
+    strings.push_back('\0');
+    return offset;
+  };
+
+  uint64_t source_size = text.size();
+  enum class Section { NONE, CREATURE, SPELL } section = Section::NONE;
+  while (!text.empty())
+  {
+    size_t end = text.find('\n');
+    std::string_view line = text.substr(0, end);
+    text = end == std::string_view::npos ? std::string_view() : text.substr(end + 1);
+
+    if (line.empty())
+      continue;
+    if (line == "creature")
+    {
+      section = Section::CREATURE;
+      continue;
+    }
+    if (line == "spell")
+    {
+      section = Section::SPELL;
+      continue;
+    }
+
+    if (section == Section::CREATURE)
+    {
+      CreatureRecord creature;
+      creature.mana_cost = std::stoi(std::string(nextField(line)));
+      creature.id = addString(nextField(line));
+      creature.name = addString(nextField(line));
+      creature.traits = addString(nextField(line));
+      creature.attack = std::stoi(std::string(nextField(line)));
+      creature.health = std::stoi(std::string(line));
+      creatures.push_back(creature);
+    }
+    else if (section == Section::SPELL)
+    {
+      SpellRecord spell{};
+      spell.cost = Spell::parseCost(nextField(line), spell.mana_cost);
+      spell.id = addString(nextField(line));
+      spell.name = addString(nextField(line));
+      spell.target = Spell::parseTarget(nextField(line));
+      spell.program_length = Spell::parseProgram(nextField(line), spell.program);
+      spell.effect = addString(line);
+      spells.push_back(spell);
+    }
+  }
+
+  CardCodebookHeader header;
+  std::memcpy(header.magic, CARD_CODEBOOK_MAGIC, sizeof(header.magic));
+  header.version = CARD_CODEBOOK_VERSION;
+  header.creature_count = creatures.size();
+  header.source_checksum = checksum;
+  header.source_size = source_size;
+  header.spell_count = spells.size();
+  header.string_table_size = strings.size();
+
+  std::vector<char> image;
+  image.reserve(sizeof(header) + creatures.size() * sizeof(CreatureRecord) + spells.size() * sizeof(SpellRecord) +
+                strings.size());
+  image.insert(image.end(), reinterpret_cast<const char *>(&header), reinterpret_cast<const char *>(&header + 1));
+  image.insert(image.end(), reinterpret_cast<const char *>(creatures.data()),
+               reinterpret_cast<const char *>(creatures.data() + creatures.size()));
+  image.insert(image.end(), reinterpret_cast<const char *>(spells.data()),
+               reinterpret_cast<const char *>(spells.data() + spells.size()));
+  image.insert(image.end(), strings.begin(), strings.end());
+  return image;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Checks whether an image belongs to the current codebook text and is complete
+///
+/// @param image image data
+/// @param size size of the image
+/// @param checksum checksum of the codebook text
+/// @param source_size size of the codebook text
+///
+/// @return true = image can be used, false = image has to be compiled again
+bool CardCodebook::isValidImage(const char *image, size_t size, uint64_t checksum, uint64_t source_size)
+{
+  if (size < sizeof(CardCodebookHeader))
+    return false;
+  const CardCodebookHeader *header = reinterpret_cast<const CardCodebookHeader *>(image);
+  if (std::memcmp(header->magic, CARD_CODEBOOK_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != CARD_CODEBOOK_VERSION || header->source_checksum != checksum ||
+      header->source_size != source_size)
+    return false;
+  if (size != sizeof(CardCodebookHeader) + header->creature_count * sizeof(CreatureRecord) +
+                  header->spell_count * sizeof(SpellRecord) + header->string_table_size)
+    return false;
+  return header->string_table_size == 0 || image[size - 1] == '\0';
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Writes a compiled image next to the codebook. The image is written to a temporary file first and
+/// renamed, so other games never map a half written image. Errors are ignored, the game then simply
+/// compiles the codebook again next time.
+///
+/// @param file_name path to the image file
+/// @param image compiled image
+///
+/// @return nothing
+void CardCodebook::writeImage(const std::string &file_name, const std::vector<char> &image)
+{
+  std::string temporary_name = file_name + "." + std::to_string(getpid()) + ".tmp";
+  std::ofstream image_file(temporary_name, std::ios::binary | std::ios::trunc);
+  if (!image_file.is_open())
+    return;
+  image_file.write(image.data(), image.size());
+  image_file.close();
+  if (!image_file || std::rename(temporary_name.c_str(), file_name.c_str()) != 0)
+    std::remove(temporary_name.c_str());
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Creates the codebook cards from the image. The creature and spell prototypes are installed as the
+/// tables all cards are created from, so the decks use the cards as the codebook defines them.
+///
+/// @param creatures creatures of the codebook are added to this list
+/// @param spells spells of the codebook are added to this list
+///
+/// @return nothing
+void CardCodebook::createCards(std::vector<std::shared_ptr<Creature>> &creatures,
+                               std::vector<std::shared_ptr<Spell>> &spells) const
+{
+  const CardCodebookHeader *header = reinterpret_cast<const CardCodebookHeader *>(image_);
+  const CreatureRecord *creature_records = reinterpret_cast<const CreatureRecord *>(header + 1);
+  const SpellRecord *spell_records = reinterpret_cast<const SpellRecord *>(creature_records + header->creature_count);
+  const char *strings = reinterpret_cast<const char *>(spell_records + header->spell_count);
+
+  std::vector<CreaturePrototype> creature_prototypes;
+  creature_prototypes.reserve(header->creature_count);
+  for (uint32_t index = 0; index < header->creature_count; index++)
+  {
+    const CreatureRecord &record = creature_records[index];
+    uint16_t traits = 0;
+    // a creature without traits has a blank trait field
+    for (const char *trait = strings + record.traits; *trait; trait++)
+    {
+      if (Creature::traitFromChar(*trait) != Trait::NON)
+        traits |= traitBit(Creature::traitFromChar(*trait));
+    }
+    creature_prototypes.push_back(
+        {strings + record.name, strings + record.id, record.health, record.attack, record.mana_cost, traits});
+  }
+  // every creature card of the game is created from this table from now on
+  const PrototypeTable<CreaturePrototype> *creature_table =
+      PrototypeTable<CreaturePrototype>::install(std::move(creature_prototypes));
+  creatures.reserve(creatures.size() + header->creature_count);
+  for (const CreaturePrototype &prototype : creature_table->getPrototypes())
+    creatures.push_back(std::make_shared<Creature>(&prototype));
+
+  std::vector<SpellPrototype> spell_prototypes;
+  spell_prototypes.reserve(header->spell_count);
+  for (uint32_t index = 0; index < header->spell_count; index++)
+  {
+    const SpellRecord &record = spell_records[index];
+    SpellPrototype &prototype = spell_prototypes.emplace_back(
+        SpellPrototype{strings + record.name, strings + record.id, record.mana_cost, record.cost, record.target,
+                       strings + record.effect, record.program_length, {}});
+    std::copy(record.program, record.program + record.program_length, prototype.program);
+  }
+  const PrototypeTable<SpellPrototype> *spell_table =
+      PrototypeTable<SpellPrototype>::install(std::move(spell_prototypes));
+  spells.reserve(spells.size() + header->spell_count);
+  for (const SpellPrototype &prototype : spell_table->getPrototypes())
+    spells.push_back(std::make_shared<Spell>(&prototype));
+  loaded_checksum = header->source_checksum;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Returns the checksum of the codebook text whose cards are in use. Files that outlive a session and
+/// depend on what the cards do store it, so they are not used with a changed codebook.
+///
+/// @return checksum, 0 = no codebook loaded yet
+uint64_t CardCodebook::getLoadedChecksum()
+{
+  return loaded_checksum;
+}
@@ -0,0 +1,49 @@
+#ifndef CARDCODEBOOK_HPP
+#define CARDCODEBOOK_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "MappedFile.hpp"
+#include "Creature.hpp"
+#include "Spell.hpp"
+
+#define CARD_CODEBOOK_FILE "data/card_codebook.txt"
+#define CARD_CODEBOOK_IMAGE_FILE "data/card_codebook.bin"
+// version of the game rules, files of solved positions are only valid for the rules they were made with
+#define GAME_RULES_VERSION 1
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Card codebook compiled into a binary image: a header with the checksum of the text file, fixed size
+/// creature and spell records and a string table. The image is kept next to the text file and mapped
+/// read-only, so all running games share its pages. It is compiled again whenever the text changes.
+///
+class CardCodebook
+{
+protected:
+  std::unique_ptr<MappedFile> mapped_image_;
+  std::vector<char> compiled_image_;
+  const char *image_;
+  size_t image_size_;
+  bool loaded_from_image_file_;
+
+  static std::vector<char> compile(std::string_view text, uint64_t checksum);
+  static bool isValidImage(const char *image, size_t size, uint64_t checksum, uint64_t source_size);
+  static void writeImage(const std::string &file_name, const std::vector<char> &image);
+
+public:
+  // Forward declarations
+  CardCodebook(const std::string &text_file_name, const std::string &image_file_name);
+  CardCodebook(const CardCodebook &) = delete;
+  ~CardCodebook() = default;
+
+  void createCards(std::vector<std::shared_ptr<Creature>> &creatures, std::vector<std::shared_ptr<Spell>> &spells) const;
+  bool wasLoadedFromImageFile() const { return loaded_from_image_file_; }
+  static uint64_t getLoadedChecksum();
+};
+
+#endif
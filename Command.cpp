@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "Command.hpp"
+#include "AllocationTracker.hpp"
 
 //---------------------------------------------------------------------------------------------------------------------
 ///
@@ -13,6 +14,7 @@
 /// @return nothing
 Command::Command(std::vector<std::string>& input)
 {
+  AllocationScope scope(AllocationSubsystem::COMMANDS);
   std::string check = input[0];
 
   for (auto &letter : check)
@@ -44,6 +46,12 @@ Command::Command(std::vector<std::string>& input)
     type_ = CommandType::CREATURE;
   else if (check == "SPELL")
     type_ = CommandType::SPELL;
+  else if (check == "SOLVE")
+    type_ = CommandType::SOLVE;
+  else if (check == "SAVE")
+    type_ = CommandType::SAVE;
+  else if (check == "POSITION")
+    type_ = CommandType::POSITION;
   else
   {
     type_ = CommandType::INVALID;
@@ -61,6 +69,9 @@ Command::Command(std::vector<std::string>& input)
 
 Command::Command(CommandType type) : type_(type) {};
 
+Command::Command(CommandType type, const std::vector<std::string> &parameters)
+    : type_(type), parameters_(parameters) {}
+
 bool Command::isQuit() const { return type_ == CommandType::QUIT; }
 
 bool Command::isDone() const { return type_ == CommandType::DONE; }
@@ -70,3 +81,70 @@ CommandType Command::getType() const { return type_; }
 std::vector<std::string> &Command::getParameters() { return parameters_; }
 
 void Command::setType(CommandType type) { type_ = type; }
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// Converts the command back into the text a player would type for it
+///
+/// @return command text, empty for invalid commands
+std::string Command::toString() const
+{
+  std::string text;
+  switch (type_)
+  {
+  case CommandType::HELP:
+    text = "help";
+    break;
+  case CommandType::GRAVEYARD:
+    text = "graveyard";
+    break;
+  case CommandType::BOARD:
+    text = "board";
+    break;
+  case CommandType::HAND:
+    text = "hand";
+    break;
+  case CommandType::INFO:
+    text = "info";
+    break;
+  case CommandType::REDRAW:
+    text = "redraw";
+    break;
+  case CommandType::STATUS:
+    text = "status";
+    break;
+  case CommandType::DONE:
+    text = "done";
+    break;
+  case CommandType::QUIT:
+    text = "quit";
+    break;
+  case CommandType::BATTLE:
+    text = "battle";
+    break;
+  case CommandType::CREATURE:
+    text = "creature";
+    break;
+  case CommandType::SPELL:
+    text = "spell";
+    break;
+  case CommandType::SOLVE:
+    text = "solve";
+    break;
+  case CommandType::SAVE:
+    text = "save";
+    break;
+  case CommandType::POSITION:
+    text = "position";
+    break;
+  case CommandType::INVALID:
+  case CommandType::WRONG_PARAM:
+    return "";
+  }
+
+  for (const auto &parameter : parameters_)
+  {
+    text += " " + parameter;
+  }
+  return text;
+}
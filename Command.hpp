@@ -19,6 +19,9 @@ enum class CommandType
   BATTLE,
   CREATURE,
   SPELL,
+  SOLVE,
+  SAVE,
+  POSITION,
   INVALID,
   WRONG_PARAM
 };
@@ -34,6 +37,7 @@ public:
   Command(std::vector<std::string>& input);
 
   Command(CommandType type);
+  Command(CommandType type, const std::vector<std::string> &parameters);
 
   Command(const Command& other) = default;
   ~Command() = default;
@@ -43,6 +47,7 @@ public:
   CommandType getType() const;
   std::vector<std::string>& getParameters();
   void setType(CommandType type);
+  std::string toString() const;
 };
 
 #endif
\ No newline at end of file
@@ -2,10 +2,12 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <thread>
 
 #include "Command.hpp"
 #include "CommandLine.hpp"
 #include "Game.hpp"
+#include "AllocationTracker.hpp"
 
 void CommandLine::removeTrailingWhitespaces(std::string &string)
 {
@@ -45,6 +47,72 @@ void CommandLine::stringToVector(const std::string &string,
   vector.push_back(string.substr(pos));
 }
 
+//-----------------------------------------------------------------------------------------------------
+///
+/// Starts the background thread reading standard input, if it is not running yet. The thread is
+/// detached because it blocks on input until the program ends.
+///
+/// @return nothing
+void CommandLine::startReading()
+{
+  if (input_)
+    return;
+  input_ = std::make_shared<InputQueue>();
+  // prompts are flushed by readCommand, the reader thread must not touch std::cout
+  std::cin.tie(nullptr);
+  std::thread(&CommandLine::readLines, input_).detach();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Reads standard input line by line into the queue until the input ends. A quit line raises the quit
+/// flag right away, even if other lines are still waiting before it.
+///
+/// @param input queue shared with the command line
+///
+/// @return nothing
+void CommandLine::readLines(std::shared_ptr<InputQueue> input)
+{
+  std::string line;
+  while (std::getline(std::cin, line))
+  {
+    if (isQuitLine(line))
+      input->quit_requested = true;
+    std::lock_guard<std::mutex> lock(input->mutex);
+    input->lines.push_back(line);
+    input->line_available.notify_one();
+  }
+  std::lock_guard<std::mutex> lock(input->mutex);
+  input->closed = true;
+  input->line_available.notify_one();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Checks whether a line of input is a quit command
+///
+/// @param line line as entered by the player
+///
+/// @return true = quit command
+bool CommandLine::isQuitLine(std::string line)
+{
+  removeWhitespacesAtEnds(line);
+  std::transform(line.begin(), line.end(), line.begin(), [](unsigned char c)
+                 { return std::tolower(c); });
+  return line == "quit";
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Checks without waiting whether a quit command has been entered. No line is consumed.
+///
+/// @return true = user wants to quit, false = no quit entered so far
+bool CommandLine::isQuitRequested()
+{
+  startReading();
+  return input_->quit_requested;
+}
+
 //-----------------------------------------------------------------------------------------------------
 ///
 /// Reads a command from the command line
@@ -55,10 +123,30 @@ void CommandLine::stringToVector(const std::string &string,
 Command CommandLine::readCommand(int player)
 {
   std::cout << std::endl
-            << "P" << player << "> ";
+            << "P" << player << "> " << std::flush;
   std::string input;
-  if (!std::getline(std::cin, input))
-    return Command(CommandType::QUIT);
+  startReading();
+  {
+    std::unique_lock<std::mutex> lock(input_->mutex);
+    input_->line_available.wait(lock, [this]() { return !input_->lines.empty() || input_->closed; });
+    if (input_->lines.empty())
+      return Command(CommandType::QUIT);
+    input = input_->lines.front();
+    input_->lines.pop_front();
+  }
+  return parseCommand(input);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Parses one line of input into a command and checks its number of parameters
+///
+/// @param input line as entered by the player
+///
+/// @return command object, CommandType::INVALID or CommandType::WRONG_PARAM for bad input
+Command CommandLine::parseCommand(std::string input)
+{
+  AllocationScope scope(AllocationSubsystem::COMMANDS);
   removeWhitespacesAtEnds(input);
   std::transform(input.begin(), input.end(), input.begin(), [](unsigned char c)
                  { return std::tolower(c); });
@@ -87,6 +175,9 @@ Command CommandLine::readCommand(int player)
   case CommandType::REDRAW:
   case CommandType::STATUS:
   case CommandType::DONE:
+  case CommandType::SOLVE:
+  case CommandType::SAVE:
+  case CommandType::POSITION:
     if (!command.getParameters().empty())
     {
       command.setType(CommandType::WRONG_PARAM);
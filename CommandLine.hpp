@@ -3,8 +3,19 @@
 
 #include <string>
 #include <map>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <condition_variable>
 #include "Command.hpp"
 
+//-----------------------------------------------------------------------------------------------------
+///
+/// Reads commands from standard input. The lines are read by a background thread, so the game can check
+/// for a quit request while a computer player is thinking: the thread raises a flag as soon as any line
+/// is a quit command. All lines are kept for the next readCommand.
+///
 class CommandLine
 {
 public:
@@ -14,12 +25,28 @@ public:
   ~CommandLine() = default;
 
   Command readCommand(int player);
+  bool isQuitRequested();
+  static Command parseCommand(std::string input);
 
 private:
-  void removeTrailingWhitespaces(std::string &string);
-  void removeLeadingWhitespace(std::string &string);
-  void removeWhitespacesAtEnds(std::string &string);
-  void stringToVector(const std::string &string, std::vector<std::string> &vector, char delimiter);
+  struct InputQueue
+  {
+    std::mutex mutex;
+    std::condition_variable line_available;
+    std::deque<std::string> lines;
+    bool closed = false;
+    std::atomic<bool> quit_requested{false};
+  };
+
+  std::shared_ptr<InputQueue> input_;
+
+  void startReading();
+  static void readLines(std::shared_ptr<InputQueue> input);
+  static bool isQuitLine(std::string line);
+  static void removeTrailingWhitespaces(std::string &string);
+  static void removeLeadingWhitespace(std::string &string);
+  static void removeWhitespacesAtEnds(std::string &string);
+  static void stringToVector(const std::string &string, std::vector<std::string> &vector, char delimiter);
 };
 
 #endif
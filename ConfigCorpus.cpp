@@ -0,0 +1,312 @@
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <memory>
+#include <thread>
+
+#include "ConfigCorpus.hpp"
+#include "MappedFile.hpp"
+#include "Exeption.hpp"
+#include "Card.hpp"
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Cuts the next line of a text, a carriage return at the end of the line is dropped
+///
+/// @param text rest of the text, the line is removed from it
+///
+/// @return line without the line break
+static std::string_view nextLine(std::string_view &text)
+{
+  size_t end = text.find('\n');
+  std::string_view line = text.substr(0, end);
+  text = end == std::string_view::npos ? std::string_view() : text.substr(end + 1);
+  if (!line.empty() && line.back() == '\r')
+    line.remove_suffix(1);
+  return line;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Reads the next whitespace separated integer of a text
+///
+/// @param text rest of the text, the number is removed from it
+/// @param value set to the number
+///
+/// @return true = number read, false = no number at this position
+static bool nextNumber(std::string_view &text, int32_t &value)
+{
+  size_t start = text.find_first_not_of(" \t\r\n");
+  if (start == std::string_view::npos)
+    return false;
+  text.remove_prefix(start);
+  std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value);
+  if (result.ec != std::errc())
+    return false;
+  text.remove_prefix(result.ptr - text.data());
+  return true;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Loads a corpus. Throws a file_error if the path can not be read.
+///
+/// @param path corpus file or directory of corpus files, the files of a directory are read in name order
+/// @param card_ids IDs of all cards in the codebook
+/// @param thread_count number of parsing threads, 0 = one per core
+///
+/// @return nothing
+ConfigCorpus::ConfigCorpus(const std::string &path, const std::vector<std::string> &card_ids,
+                           unsigned int thread_count)
+    : card_ids_(card_ids)
+{
+  for (uint16_t index = 0; index < card_ids_.size(); index++)
+  {
+    card_indices_.emplace(card_ids_[index], index);
+  }
+
+  std::vector<std::string> file_names;
+  std::error_code error_code;
+  if (std::filesystem::is_directory(path, error_code))
+  {
+    for (const auto &entry : std::filesystem::directory_iterator(path, error_code))
+    {
+      if (entry.is_regular_file(error_code))
+        file_names.push_back(entry.path().string());
+    }
+    std::sort(file_names.begin(), file_names.end());
+  }
+  else
+  {
+    file_names.push_back(path);
+  }
+
+  // split the files into records, the records are views into the mapped files
+  std::vector<std::unique_ptr<MappedFile>> files;
+  std::vector<Record> records;
+  for (const std::string &file_name : file_names)
+  {
+    try
+    {
+      files.push_back(std::make_unique<MappedFile>(file_name, false));
+    }
+    catch (const file_error &e)
+    {
+      if (file_names.size() == 1)
+        throw;
+      errors_.push_back(std::string(e.what()));
+      continue;
+    }
+
+    std::string_view text(static_cast<const char *>(files.back()->getData()), files.back()->getSize());
+    unsigned long record_number = 0;
+    while (!text.empty())
+    {
+      std::string_view rest = text;
+      if (nextLine(rest) != "GAME")
+      {
+        text = rest;
+        continue;
+      }
+
+      // the record ends where the next one starts
+      std::string_view record_end = rest;
+      while (!record_end.empty())
+      {
+        std::string_view after_line = record_end;
+        if (nextLine(after_line) == "GAME")
+          break;
+        record_end = after_line;
+      }
+      size_t record_size = record_end.data() - text.data();
+      records.push_back({text.substr(0, record_size), file_name + ":" + std::to_string(++record_number)});
+      text = record_end;
+    }
+  }
+
+  if (thread_count == 0)
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  thread_count = std::min<unsigned long>(thread_count, std::max<unsigned long>(1, records.size()));
+
+  struct Part
+  {
+    std::vector<MatchSpec> matches;
+    std::vector<uint16_t> cards;
+    std::vector<std::string> errors;
+  };
+  std::vector<Part> parts(thread_count);
+  std::vector<std::thread> workers;
+  for (unsigned int worker = 0; worker < thread_count; worker++)
+  {
+    workers.emplace_back([this, &records, &parts, worker, thread_count]()
+                         {
+      Part &part = parts[worker];
+      unsigned long begin = records.size() * worker / thread_count;
+      unsigned long end = records.size() * (worker + 1) / thread_count;
+      for (unsigned long index = begin; index < end; index++)
+      {
+        MatchSpec match;
+        std::string error;
+        if (parseRecord(records[index], index, match, part.cards, error))
+          part.matches.push_back(match);
+        else
+          part.errors.push_back(records[index].source + ": " + error);
+      } });
+  }
+  for (auto &worker : workers)
+  {
+    worker.join();
+  }
+
+  for (Part &part : parts)
+  {
+    uint32_t card_offset = cards_.size();
+    for (MatchSpec &match : part.matches)
+    {
+      match.deck_begin[0] += card_offset;
+      match.deck_begin[1] += card_offset;
+      matches_.push_back(match);
+    }
+    cards_.insert(cards_.end(), part.cards.begin(), part.cards.end());
+    errors_.insert(errors_.end(), part.errors.begin(), part.errors.end());
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Parses one GAME config: health, max rounds, deck size and mana pool, then the two deck lines
+///
+/// @param record text of the config, starting with the line GAME
+/// @param config_id number of the config in the corpus
+/// @param match set to the parsed config
+/// @param cards deck cards are added to this list, the match refers to them by position
+/// @param error set to the reason if the config is invalid
+///
+/// @return true = valid config, false = invalid config
+bool ConfigCorpus::parseRecord(const Record &record, uint32_t config_id, MatchSpec &match,
+                               std::vector<uint16_t> &cards, std::string &error) const
+{
+  std::string_view text = record.text;
+  nextLine(text);
+
+  match.config_id = config_id;
+  if (!nextNumber(text, match.health) || !nextNumber(text, match.max_rounds) ||
+      !nextNumber(text, match.deck_size) || !nextNumber(text, match.mana_pool))
+  {
+    error = "expected health, max rounds, deck size and mana pool";
+    return false;
+  }
+  if (match.health <= 0 || match.max_rounds <= 0 || match.mana_pool < 0)
+  {
+    error = "invalid game settings";
+    return false;
+  }
+  nextLine(text);
+
+  size_t card_count = cards.size();
+  for (int player = 0; player < 2; player++)
+  {
+    std::string_view line;
+    while (line.empty() && !text.empty())
+    {
+      line = nextLine(text);
+    }
+    match.deck_begin[player] = cards.size();
+    if (!parseDeckLine(line, cards, error))
+    {
+      cards.resize(card_count);
+      return false;
+    }
+    match.deck_length[player] = cards.size() - match.deck_begin[player];
+    if (match.deck_length[player] < INITIAL_HAND_SIZE)
+    {
+      cards.resize(card_count);
+      error = "deck " + std::to_string(player + 1) + " has fewer than " + std::to_string(INITIAL_HAND_SIZE) + " cards";
+      return false;
+    }
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Parses a deck line of ';' separated card IDs and checks them against the codebook
+///
+/// @param line deck line
+/// @param cards codebook indices of the cards are added to this list
+/// @param error set to the reason if the line is invalid
+///
+/// @return true = valid deck line, false = empty deck or unknown card ID
+bool ConfigCorpus::parseDeckLine(std::string_view line, std::vector<uint16_t> &cards, std::string &error) const
+{
+  if (line.empty())
+  {
+    error = "missing deck line";
+    return false;
+  }
+  while (!line.empty())
+  {
+    size_t pos = line.find(';');
+    std::string_view id = line.substr(0, pos);
+    line = pos == std::string_view::npos ? std::string_view() : line.substr(pos + 1);
+
+    auto card = card_indices_.find(id);
+    if (card == card_indices_.end())
+    {
+      error = "unknown card ID '" + std::string(id) + "'";
+      return false;
+    }
+    cards.push_back(card->second);
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Sets up the players of a match like Init::loadConfig does for a single config
+///
+/// @param match config of the match
+/// @param player1 first player, gets the first deck
+/// @param player2 second player, gets the second deck
+/// @param arena arena of the match the cards are created in, nullptr = heap
+///
+/// @return nothing
+void ConfigCorpus::createPlayers(const MatchSpec &match, Player &player1, Player &player2,
+                                 const std::shared_ptr<CardArena> &arena) const
+{
+  Player *players[2] = {&player1, &player2};
+  for (int player = 0; player < 2; player++)
+  {
+    players[player]->setHealth(match.health);
+    players[player]->setManaPool(match.mana_pool);
+    players[player]->setMana(match.mana_pool);
+    for (uint32_t index = 0; index < match.deck_length[player]; index++)
+    {
+      const std::string &id = card_ids_[cards_[match.deck_begin[player] + index]];
+      std::shared_ptr<Card> card = Card::createCardFromID(id, arena);
+      if (card == nullptr)
+        continue;
+      players[player]->addCardToDeck(card);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Returns the deck of a player as it is written in the config
+///
+/// @param match config of the match
+/// @param player 1 or 2
+///
+/// @return card IDs of the deck separated by semicolons
+std::string ConfigCorpus::getDeckText(const MatchSpec &match, int player) const
+{
+  std::string text;
+  for (uint32_t index = 0; index < match.deck_length[player - 1]; index++)
+  {
+    if (index)
+      text += ';';
+    text += card_ids_[cards_[match.deck_begin[player - 1] + index]];
+  }
+  return text;
+}
@@ -0,0 +1,67 @@
+#ifndef CONFIGCORPUS_HPP
+#define CONFIGCORPUS_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include "Player.hpp"
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// One GAME config of a corpus. The decks are stored as codebook card indices in the card list of the
+/// corpus.
+///
+struct MatchSpec
+{
+  uint32_t config_id;
+  int32_t health;
+  int32_t max_rounds;
+  int32_t deck_size;
+  int32_t mana_pool;
+  uint32_t deck_begin[2];
+  uint32_t deck_length[2];
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Many GAME configs loaded at once, for batch runs. The corpus is either a file with configs one after
+/// another, each starting with the line GAME, or a directory of such files. The files are mapped and
+/// the configs are parsed in parallel without copying the text. Invalid configs are skipped and
+/// reported.
+///
+class ConfigCorpus
+{
+protected:
+  std::vector<std::string> card_ids_;
+  std::unordered_map<std::string_view, uint16_t> card_indices_;
+  std::vector<MatchSpec> matches_;
+  std::vector<uint16_t> cards_;
+  std::vector<std::string> errors_;
+
+  struct Record
+  {
+    std::string_view text;
+    std::string source;
+  };
+
+  bool parseRecord(const Record &record, uint32_t config_id, MatchSpec &match, std::vector<uint16_t> &cards,
+                   std::string &error) const;
+  bool parseDeckLine(std::string_view line, std::vector<uint16_t> &cards, std::string &error) const;
+
+public:
+  // Forward declarations
+  ConfigCorpus(const std::string &path, const std::vector<std::string> &card_ids, unsigned int thread_count);
+  ConfigCorpus(const ConfigCorpus &) = delete;
+  ~ConfigCorpus() = default;
+
+  const std::vector<MatchSpec> &getMatches() const { return matches_; }
+  const std::vector<std::string> &getErrors() const { return errors_; }
+  void createPlayers(const MatchSpec &match, Player &player1, Player &player2,
+                     const std::shared_ptr<CardArena> &arena = nullptr) const;
+  std::string getDeckText(const MatchSpec &match, int player) const;
+};
+
+#endif
@@ -1,20 +1,30 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <algorithm>
 
 #include "Creature.hpp"
+#include "AllocationTracker.hpp"
+#include "PrototypeTable.hpp"
 
-Creature::Creature(std::string name, std::string ID, int base_health, int base_attack,
-                   int mana_str_cost, std::vector<Trait> traits)
-    : Card(name, ID),
-      base_health_(base_health),
-      current_health_(base_health),
-      base_attack_(base_attack),
-      current_attack_(base_attack),
-      traits_(traits),
-      base_traits_(traits),
-      mana_cost_(mana_str_cost) {}
+Creature::Creature(const CreaturePrototype *prototype)
+    : prototype_(prototype),
+      current_health_(prototype->base_health),
+      current_attack_(prototype->base_attack),
+      placed_in_round_(0),
+      traits_(prototype->base_traits),
+      board_location_(-1) {}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Finds the prototype of a creature of the card codebook
+///
+/// @param ID card ID
+///
+/// @return prototype, nullptr = no creature with this ID
+const CreaturePrototype *Creature::findPrototype(const std::string &ID)
+{
+  return PrototypeTable<CreaturePrototype>::lookup(ID);
+}
 
 //-----------------------------------------------------------------------------------------------------
 ///
@@ -22,33 +32,38 @@ Creature::Creature(std::string name, std::string ID, int base_health, int base_a
 ///
 /// @param border_info border information
 /// @param border_d border data
+/// @param out stream to print to
 ///
 /// @return nothing
-void Creature::printInfo(std::string border_info, std::string border_d)
+void Creature::printInfo(std::string border_info, std::string border_d, std::ostream &out)
 {
-  std::cout << border_info << std::endl;
-  if (mana_cost_)
+  out << border_info << std::endl;
+  if (prototype_->mana_cost)
   {
-    std::cout << name_ << " [" << ID_ << "] " << "(" << mana_cost_ << " mana" << ")" << std::endl;
+    out << prototype_->name << " [" << prototype_->id << "] " << "(" << prototype_->mana_cost << " mana" << ")"
+        << std::endl;
   }
   else
   {
-    std::cout << name_ << " [" << ID_ << "] " << "(" << "XX mana" << ")" << std::endl;
+    out << prototype_->name << " [" << prototype_->id << "] " << "(" << "XX mana" << ")" << std::endl;
   }
-  std::cout << "Type: Creature" << std::endl
-            << "Base Attack: " << base_attack_ << std::endl
-            << "Base Health: " << base_health_ << std::endl
-            << "Base Traits: ";
-  for (auto it : traits_)
+  out << "Type: Creature" << std::endl
+      << "Base Attack: " << prototype_->base_attack << std::endl
+      << "Base Health: " << prototype_->base_health << std::endl
+      << "Base Traits: ";
+  std::vector<Trait> traits = getTraits();
+  if (traits.empty())
+    out << nameFromTrait(Trait::NON);
+  for (auto it : traits)
   {
-    std::cout << nameFromTrait(it);
-    if (it != Trait::NON && it != traits_.back())
+    out << nameFromTrait(it);
+    if (it != Trait::NON && it != traits.back())
     {
-      std::cout << ", ";
+      out << ", ";
     }
   }
-  std::cout << "\n";
-  std::cout << border_d << std::endl;
+  out << "\n";
+  out << border_d << std::endl;
 }
 
 //-----------------------------------------------------------------------------------------------------
@@ -130,22 +145,24 @@ Trait Creature::traitFromChar(char c)
 /// @return vector of strings representing the card
 std::vector<std::string> Creature::printCard() const
 {
+  AllocationScope scope(AllocationSubsystem::CARDS);
   std::vector<std::string> card;
 
   // line 1
-  std::string mana_str = std::to_string(mana_cost_);
+  std::string mana_str = std::to_string(prototype_->mana_cost);
   if (mana_str.length() == 1)
     mana_str = "0" + mana_str;
-  else if (mana_cost_ > 99)
+  else if (prototype_->mana_cost > 99)
     mana_str = "**";
   card.push_back(" _____M" + mana_str);
 
   // line 2
-  card.push_back("| " + ID_ + " |");
+  card.push_back("| " + prototype_->id + " |");
 
   // line 3
+  std::vector<Trait> traits = getTraits();
   std::string traits_str = "| ";
-  for (Trait t : traits_)
+  for (Trait t : traits)
   {
     switch (t)
     {
@@ -189,7 +206,7 @@ std::vector<std::string> Creature::printCard() const
   }
   else
   {
-    for (unsigned long spaces = 0; spaces < 5 - traits_.size(); spaces++)
+    for (unsigned long spaces = 0; spaces < 5 - traits.size(); spaces++)
     {
       traits_str += " ";
     }
@@ -216,27 +233,18 @@ std::vector<std::string> Creature::printCard() const
 
 //-----------------------------------------------------------------------------------------------------
 ///
-/// Adds a trait to the creature
+/// Lists the current traits of the creature
 ///
-/// @param t trait
-///
-/// @return nothing
-void Creature::addTrait(Trait t)
+/// @return traits in the order of the Trait enum
+std::vector<Trait> Creature::getTraits() const
 {
-  for (unsigned long i = 0; i < traits_.size(); i++)
+  std::vector<Trait> traits;
+  for (int trait = Trait::NON; trait <= Trait::V; trait++)
   {
-    if (traits_[i] == t)
-    {
-      return;
-    }
+    if (traits_ & traitBit(static_cast<Trait>(trait)))
+      traits.push_back(static_cast<Trait>(trait));
   }
-  traits_.push_back(t);
-  sortTraits();
-}
-
-void Creature::damageCreature(int damage)
-{
-  current_health_ -= damage;
+  return traits;
 }
 
 void Creature::setRoundPlacement(int round_number)
@@ -246,36 +254,12 @@ void Creature::setRoundPlacement(int round_number)
 
 //-----------------------------------------------------------------------------------------------------
 ///
-/// Removes a trait from the creature
+/// Removes the first trait of the creature in the order of the Trait enum
 ///
 /// @return nothing
 void Creature::removeTrait()
 {
-  if (traits_.empty())
-  {
-    return;
-  }
-  sortTraits();
-  traits_.erase(traits_.begin());
-}
-
-//-----------------------------------------------------------------------------------------------------
-///
-/// Checks if the creature has a specific trait
-///
-/// @param t trait
-///
-/// @return true = trait found, false = trait not found
-bool Creature::checkTrait(Trait t) const
-{
-  for (unsigned long i = 0; i < traits_.size(); i++)
-  {
-    if (traits_[i] == t)
-    {
-      return true;
-    }
-  }
-  return false;
+  traits_ &= traits_ - 1;
 }
 
 //-----------------------------------------------------------------------------------------------------
@@ -285,9 +269,9 @@ bool Creature::checkTrait(Trait t) const
 /// @return nothing
 void Creature::resetAttributes()
 {
-  current_health_ = base_health_;
-  current_attack_ = base_attack_;
-  traits_ = base_traits_;
+  current_health_ = prototype_->base_health;
+  current_attack_ = prototype_->base_attack;
+  traits_ = prototype_->base_traits;
 }
 
 //-----------------------------------------------------------------------------------------------------
@@ -297,9 +281,9 @@ void Creature::resetAttributes()
 /// @return 0 = doesnt reset the health, 1 = health reset
 int Creature::resetHealth()
 {
-  if (current_health_ >= base_health_)
+  if (current_health_ >= prototype_->base_health)
     return 0;
-  current_health_ = base_health_;
+  current_health_ = prototype_->base_health;
   return 1;
 }
 
@@ -310,19 +294,5 @@ int Creature::resetHealth()
 /// @return nothing
 void Creature::removeUndying()
 {
-  auto it = std::find(traits_.begin(), traits_.end(), Trait::U);
-  if (it != traits_.end())
-  {
-    traits_.erase(it);
-  }
-}
-
-//-----------------------------------------------------------------------------------------------------
-///
-/// Sorts the traits of the creature
-///
-/// @return nothing
-void Creature::sortTraits()
-{
-  std::sort(traits_.begin(), traits_.end());
+  traits_ &= ~traitBit(Trait::U);
 }
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <cstdint>
 
 #include "Card.hpp"
 #include "Command.hpp"
@@ -23,58 +24,83 @@ enum Trait
   V
 };
 
+//-----------------------------------------------------------------------------------------------------
+///
+/// Bit of a trait in a trait mask, the traits of a creature are kept as one bit per Trait value
+///
+/// @param trait trait
+///
+/// @return bit of the trait
+constexpr uint16_t traitBit(Trait trait)
+{
+  return static_cast<uint16_t>(1u << trait);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Everything that all creatures with the same ID have in common. Prototypes are never changed or
+/// freed, the creatures only point to them.
+///
+struct CreaturePrototype
+{
+  std::string name;
+  std::string id;
+  int base_health;
+  int base_attack;
+  int mana_cost;
+  uint16_t base_traits;
+};
+
 class Creature : public Card
 {
 protected:
-  int base_health_;
+  const CreaturePrototype *prototype_;
   int current_health_;
-  int base_attack_;
   int current_attack_;
-  std::vector<Trait> traits_; // base_traits_
-  std::vector<Trait> base_traits_;
-  int mana_cost_;
-  std::string effect;
   int placed_in_round_;
+  uint16_t traits_;
+  int8_t board_location_;
 
 public:
   // Forward declarations
-  Creature() {};
-  Creature(std::string name, std::string ID, int base_health, int base_attack, int mana_cost_, std::vector<Trait> traits);
+  explicit Creature(const CreaturePrototype *prototype);
   ~Creature() = default;
 
-  void printInfo(std::string border_info, std::string border_d) override;
-  Trait traitFromChar(char c);
-  std::string nameFromTrait(Trait t);
+  static const CreaturePrototype *findPrototype(const std::string &ID);
+
+  void printInfo(std::string border_info, std::string border_d, std::ostream &out) override;
+  static Trait traitFromChar(char c);
+  static std::string nameFromTrait(Trait t);
   std::vector<std::string> printCard() const override;
 
-  void setManaCost(int mana_cost) { mana_cost_ = mana_cost; }
-  void setBaseTraits(const std::vector<Trait> &traits) { traits_ = traits; }
-  void setBaseAttack(int base_attack) { base_attack_ = base_attack; }
-  void setBaseHealth(int base_health) { base_health_ = base_health; }
+  const std::string &getCardID() const override { return prototype_->id; }
+  const std::string &getCardName() const override { return prototype_->name; }
+
   void resetAttributes();
   int resetHealth();
   void removeUndying();
 
   int getCurrentAttack() const { return current_attack_; }
   int getCurrentHealth() const { return current_health_; }
-  int getManaCost() const { return mana_cost_; }
-  int getBaseAttack() const { return base_attack_; }
-  int getBaseHealth() const { return base_health_; }
-  const std::vector<Trait> &getTraits() const { return traits_; }
+  int getManaCost() const { return prototype_->mana_cost; }
+  int getBaseAttack() const { return prototype_->base_attack; }
+  int getBaseHealth() const { return prototype_->base_health; }
+  std::vector<Trait> getTraits() const;
+  uint16_t getTraitMask() const { return traits_; }
+  uint16_t getBaseTraitMask() const { return prototype_->base_traits; }
   void increaseCurrentAttack(int attack) { current_attack_ += attack; }
-  void increaseCurrentHealth(int health) { current_health_ += health; }
   void removeTrait();
-  void addTrait(Trait t);
-  void damageCreature(int damage);
+  void addTrait(Trait t) { traits_ |= traitBit(t); }
   void setCurrentAttack(int attack) { current_attack_ = attack; }
   void setCurrentHealth(int health) { current_health_ = health; }
-  void setCurrentTraits(const std::vector<Trait> &traits) { traits_ = traits; }
+  void setTraitMask(uint16_t traits) { traits_ = traits; }
   bool isDead() const { return current_health_ <= 0; }
-  bool checkTrait(Trait t) const;
+  bool checkTrait(Trait t) const { return traits_ & traitBit(t); }
 
   int getRoundPlacement() const { return placed_in_round_; };
+  int getBoardLocation() const { return board_location_; }
+  void setBoardLocation(int location) { board_location_ = static_cast<int8_t>(location); }
   void setRoundPlacement(int round_number);
-  void sortTraits();
 };
 
 #endif
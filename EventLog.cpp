@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "EventLog.hpp"
+#include "Exeption.hpp"
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Adds an event, called by the game thread only
+///
+/// @param event event to add
+///
+/// @return true = added, false = ring full, the event was dropped
+bool EventRing::push(const GameEvent &event)
+{
+  uint64_t head = head_.load(std::memory_order_relaxed);
+  if (head - tail_.load(std::memory_order_acquire) >= EVENT_RING_CAPACITY)
+  {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  events_[head & (EVENT_RING_CAPACITY - 1)] = event;
+  head_.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Takes the oldest event, called by the log writer only
+///
+/// @param event set to the oldest event
+///
+/// @return true = event taken, false = ring empty
+bool EventRing::pop(GameEvent &event)
+{
+  uint64_t tail = tail_.load(std::memory_order_relaxed);
+  if (tail == head_.load(std::memory_order_acquire))
+    return false;
+  event = events_[tail & (EVENT_RING_CAPACITY - 1)];
+  tail_.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Opens the log for appending and starts the writer thread, throws a file_error if the file can not be
+/// opened
+///
+/// @param file_name path to the log file
+///
+/// @return nothing
+EventLog::EventLog(const std::string &file_name) : file_descriptor_(-1), closing_(false)
+{
+  file_descriptor_ = open(file_name.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (file_descriptor_ < 0)
+  {
+    throw file_error(file_name);
+  }
+  writer_ = std::thread(&EventLog::writeEvents, this);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Writes the events that are still buffered and closes the log
+///
+/// @return nothing
+EventLog::~EventLog()
+{
+  closing_ = true;
+  writer_.join();
+  close(file_descriptor_);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Creates the ring buffer of a new game
+///
+/// @param game_id ID written with every event of the game
+///
+/// @return ring buffer, the game releases it when it has ended
+std::shared_ptr<EventRing> EventLog::openGame(uint64_t game_id)
+{
+  std::shared_ptr<EventRing> ring = std::make_shared<EventRing>(game_id);
+  std::lock_guard<std::mutex> lock(rings_mutex_);
+  rings_.push_back(ring);
+  sequence_numbers_.push_back(0);
+  return ring;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Moves the events of all rings into the buffer and forgets rings that were released and are empty.
+/// Events of the last batch that could not be written come first as dropped lines.
+///
+/// @param buffer JSON lines are appended to it
+///
+/// @return true = no ring is open any more
+bool EventLog::drainRings(std::string &buffer)
+{
+  for (const auto &[game_id, dropped] : unwritten_counts_)
+  {
+    appendDropped(buffer, game_id, dropped);
+    buffered_games_.push_back({buffer.size(), game_id, dropped});
+  }
+  unwritten_counts_.clear();
+
+  std::lock_guard<std::mutex> lock(rings_mutex_);
+  for (unsigned long index = 0; index < rings_.size();)
+  {
+    EventRing &ring = *rings_[index];
+    bool released = rings_[index].use_count() == 1;
+    GameEvent event;
+    while (ring.pop(event))
+    {
+      buffer += formatEvent(ring.getGameId(), sequence_numbers_[index]++, event);
+    }
+    uint64_t dropped = ring.takeDroppedCount();
+    if (dropped)
+      appendDropped(buffer, ring.getGameId(), dropped);
+    buffered_games_.push_back({buffer.size(), ring.getGameId(), dropped});
+
+    if (released && ring.isEmpty())
+    {
+      rings_.erase(rings_.begin() + index);
+      sequence_numbers_.erase(sequence_numbers_.begin() + index);
+    }
+    else
+    {
+      index++;
+    }
+  }
+  return rings_.empty();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Writer thread: polls the rings, so the game threads never have to wake it up
+///
+/// @return nothing
+void EventLog::writeEvents()
+{
+  std::string buffer;
+  while (true)
+  {
+    bool closing = closing_;
+    drainRings(buffer);
+    size_t written = 0;
+    while (written < buffer.size())
+    {
+      ssize_t result = write(file_descriptor_, buffer.data() + written, buffer.size() - written);
+      if (result < 0 && errno == EINTR)
+        continue;
+      if (result <= 0)
+        break;
+      written += static_cast<size_t>(result);
+    }
+    if (written < buffer.size())
+      countUnwrittenEvents(buffer, written);
+    buffer.clear();
+    buffered_games_.clear();
+    if (closing)
+      return;
+    std::this_thread::sleep_for(std::chrono::milliseconds(EVENT_LOG_POLL_INTERVAL_MS));
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Counts the events behind the written part of the buffer per game, they are logged as dropped with
+/// the next batch
+///
+/// @param buffer JSON lines of the batch
+/// @param written number of bytes that reached the file
+///
+/// @return nothing
+void EventLog::countUnwrittenEvents(const std::string &buffer, size_t written)
+{
+  size_t start = 0;
+  for (const BufferedGame &game : buffered_games_)
+  {
+    if (game.end > written)
+    {
+      size_t first = std::max(start, written);
+      uint64_t lines = std::count(buffer.begin() + first, buffer.begin() + game.end, '\n');
+      // the dropped line stands for more than one event
+      uint64_t events = game.dropped ? lines - 1 + game.dropped : lines;
+      if (events)
+        unwritten_counts_.push_back({game.game_id, events});
+    }
+    start = game.end;
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Appends the line that stands for dropped events of a game
+///
+/// @param buffer JSON lines are appended to it
+/// @param game_id ID of the game
+/// @param dropped number of dropped events
+///
+/// @return nothing
+void EventLog::appendDropped(std::string &buffer, uint64_t game_id, uint64_t dropped)
+{
+  buffer += "{\"game\":" + std::to_string(game_id) + ",\"type\":\"dropped\",\"value\":" +
+            std::to_string(dropped) + "}\n";
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Formats an event as one JSON line
+///
+/// @param game_id ID of the game
+/// @param sequence_number number of the event within its game
+/// @param event event to format
+///
+/// @return JSON line including the line break
+std::string EventLog::formatEvent(uint64_t game_id, uint64_t sequence_number, const GameEvent &event)
+{
+  std::string line = "{\"game\":" + std::to_string(game_id) + ",\"seq\":" + std::to_string(sequence_number) +
+                     ",\"round\":" + std::to_string(event.round) + ",\"type\":\"" + typeName(event.type) + "\"";
+  if (event.player)
+    line += ",\"player\":" + std::to_string(event.player);
+  if (event.slot >= 0)
+    line += ",\"slot\":" + std::to_string(event.slot + 1);
+  if (event.trait)
+    line += ",\"trait\":\"" + std::string(1, event.trait) + "\"";
+  if (event.card[0])
+    line += ",\"card\":\"" + std::string(event.card) + "\"";
+  if (event.target[0])
+    line += ",\"target\":\"" + std::string(event.target) + "\"";
+  line += ",\"value\":" + std::to_string(event.value) + "}\n";
+  return line;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Name of an event type as it is written to the log
+///
+/// @param type event type
+///
+/// @return name of the type
+const char *EventLog::typeName(EventType type)
+{
+  switch (type)
+  {
+  case EventType::ROUND_START:
+    return "round_start";
+  case EventType::SPELL:
+    return "spell";
+  case EventType::DIRECT_ATTACK:
+    return "direct_attack";
+  case EventType::FIGHT:
+    return "fight";
+  case EventType::TRAIT:
+    return "trait";
+  case EventType::DEATH:
+    return "death";
+  case EventType::UNDYING:
+    return "undying";
+  case EventType::TEMPORARY:
+    return "temporary";
+  case EventType::GAME_END:
+    return "game_end";
+  }
+  return "unknown";
+}
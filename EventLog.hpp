@@ -0,0 +1,116 @@
+#ifndef EVENTLOG_HPP
+#define EVENTLOG_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <cstdint>
+
+#define EVENT_LOG_FILE "data/events.jsonl"
+#define EVENT_RING_CAPACITY 4096
+#define EVENT_LOG_POLL_INTERVAL_MS 20
+#define EVENT_CARD_ID_LENGTH 8
+
+enum class EventType : uint8_t
+{
+  ROUND_START,
+  SPELL,
+  DIRECT_ATTACK,
+  FIGHT,
+  TRAIT,
+  DEATH,
+  UNDYING,
+  TEMPORARY,
+  GAME_END
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// One game event. Fields that do not apply to an event type are 0, -1 for the slot or empty.
+///
+struct GameEvent
+{
+  EventType type;
+  char trait;
+  uint8_t player;
+  int8_t slot;
+  int32_t round;
+  int32_t value;
+  char card[EVENT_CARD_ID_LENGTH];
+  char target[EVENT_CARD_ID_LENGTH];
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Lock-free ring buffer between one game thread and the log writer. Pushing never blocks and never
+/// makes a system call; if the writer falls behind, events are dropped and counted.
+///
+class EventRing
+{
+protected:
+  uint64_t game_id_;
+  GameEvent events_[EVENT_RING_CAPACITY];
+  std::atomic<uint64_t> head_;
+  std::atomic<uint64_t> tail_;
+  std::atomic<uint64_t> dropped_;
+
+public:
+  // Forward declarations
+  explicit EventRing(uint64_t game_id) : game_id_(game_id), head_(0), tail_(0), dropped_(0) {}
+  EventRing(const EventRing &) = delete;
+  ~EventRing() = default;
+
+  bool push(const GameEvent &event);
+  bool pop(GameEvent &event);
+  bool isEmpty() const { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+  uint64_t getGameId() const { return game_id_; }
+  uint64_t takeDroppedCount() { return dropped_.exchange(0, std::memory_order_relaxed); }
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// JSON Lines log of game events. Every game writes into its own EventRing; a background thread polls
+/// the rings and appends the events to the log file. A ring is closed when the game releases it. Events
+/// that can not be written are counted as dropped, like events of a full ring.
+///
+class EventLog
+{
+protected:
+  // events of one game in the write buffer, the dropped line is always the last one
+  struct BufferedGame
+  {
+    size_t end;
+    uint64_t game_id;
+    uint64_t dropped;
+  };
+
+  int file_descriptor_;
+  std::mutex rings_mutex_;
+  std::vector<std::shared_ptr<EventRing>> rings_;
+  std::vector<uint64_t> sequence_numbers_;
+  std::vector<BufferedGame> buffered_games_;
+  std::vector<std::pair<uint64_t, uint64_t>> unwritten_counts_;
+  std::atomic<bool> closing_;
+  std::thread writer_;
+
+  void writeEvents();
+  bool drainRings(std::string &buffer);
+  void countUnwrittenEvents(const std::string &buffer, size_t written);
+  static void appendDropped(std::string &buffer, uint64_t game_id, uint64_t dropped);
+
+public:
+  // Forward declarations
+  explicit EventLog(const std::string &file_name);
+  EventLog(const EventLog &) = delete;
+  ~EventLog();
+
+  std::shared_ptr<EventRing> openGame(uint64_t game_id);
+
+  static std::string formatEvent(uint64_t game_id, uint64_t sequence_number, const GameEvent &event);
+  static const char *typeName(EventType type);
+};
+
+#endif
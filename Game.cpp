@@ -3,44 +3,137 @@
 #include "Game.hpp"
 #include "Command.hpp"
 #include "Init.hpp"
+#include "Solver.hpp"
+#include "SolveTable.hpp"
+#include "BatchStatistics.hpp"
+#include "CardCodebook.hpp"
 #include <fstream>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <utility>
+#include <sstream>
+#include <charconv>
+#include <string_view>
+#include <thread>
+#include <cstdio>
+#include <unistd.h>
+
+#define SOLVER_NODE_LIMIT 500000
+#define TRAIT_LETTERS "-BCFHLPRTUV"
 
 Game::Game(Player &player1, Player &player2, const std::map<std::string, std::string> &errors,
            const std::map<std::string, std::string> &infos, const std::map<std::string, std::string> &descriptions, int max_rounds, std::vector<std::shared_ptr<Creature>> creature_codebook,
-           std::vector<std::shared_ptr<Spell>> spell_codebook)
-    : players_{player1, player2}, attacker_(1), defender_(2), max_rounds_(max_rounds), round_(0), board_(), errors_(errors),
-      infos_(infos), descriptions_(descriptions), creature_codebook_(creature_codebook), spell_codebook_(spell_codebook)
+           std::vector<std::shared_ptr<Spell>> spell_codebook, std::ostream *out, std::shared_ptr<CardArena> arena)
+    : arena_(arena ? arena : std::make_shared<CardArena>()), players_{player1, player2}, attacker_(1), defender_(2), active_player_(1), max_rounds_(max_rounds), round_(0), board_(),
+      errors_(std::make_shared<const std::map<std::string, std::string>>(errors)),
+      infos_(std::make_shared<const std::map<std::string, std::string>>(infos)),
+      descriptions_(std::make_shared<const std::map<std::string, std::string>>(descriptions)),
+      creature_codebook_(std::make_shared<const std::vector<std::shared_ptr<Creature>>>(creature_codebook)),
+      spell_codebook_(std::make_shared<const std::vector<std::shared_ptr<Spell>>>(spell_codebook)),
+      allocations_(nullptr), counters_(nullptr), null_out_(nullptr), out_(out ? out : &null_out_)
 {
-  std::cout << getDescWithId("D_BORDER_D") << std::endl;
-  std::cout << getDescWithId("D_WELCOME") << std::endl;
-  std::cout << getDescWithId("D_BORDER_D") << std::endl;
+  printWelcome();
   players_[0].drawInitialCards();
   players_[1].drawInitialCards();
 }
 
+//-----------------------------------------------------------------------------------------------------
+///
+/// Copies a game including all of its cards, so the copy can be played on without changing the
+/// original. Messages and codebooks are never changed and stay shared. Copies do not log events,
+/// allocations or match counters. The
+/// copied creatures go to an arena of the copy, so they are allocated and released in one step.
+///
+/// @param other game to copy
+///
+/// @return nothing
+Game::Game(const Game &other)
+    : arena_(std::make_shared<CardArena>()), players_(other.players_), attacker_(other.attacker_), defender_(other.defender_),
+      active_player_(other.active_player_), max_rounds_(other.max_rounds_), round_(other.round_), board_(other.board_),
+      errors_(other.errors_), infos_(other.infos_), descriptions_(other.descriptions_),
+      creature_codebook_(other.creature_codebook_), spell_codebook_(other.spell_codebook_),
+      solve_table_(other.solve_table_), events_(nullptr), allocations_(nullptr), counters_(nullptr), null_out_(nullptr),
+      out_(other.out_ == &other.null_out_ ? &null_out_ : other.out_)
+{
+  players_[0].detachCards(arena_);
+  players_[1].detachCards(arena_);
+  board_.detachCards(arena_);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Prints the welcome message of a new game
+///
+/// @return nothing
+void Game::printWelcome()
+{
+  *out_ << getDescWithId("D_BORDER_D") << std::endl;
+  *out_ << getDescWithId("D_WELCOME") << std::endl;
+  *out_ << getDescWithId("D_BORDER_D") << std::endl;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Sets the stream all game messages are printed to
+///
+/// @param out output stream, nullptr = discard all messages
+///
+/// @return nothing
+void Game::setOutputStream(std::ostream *out)
+{
+  out_ = out ? out : &null_out_;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Adds an event to the event stream and the match counters of the game, if it has them
+///
+/// @param type type of the event
+/// @param player player the event belongs to, 0 = none
+/// @param slot board slot (0 to 6), -1 = none
+/// @param card ID of the card causing the event
+/// @param target ID of the card affected by the event
+/// @param value damage, mana cost or game status, depending on the event
+/// @param trait trait letter of a trait event
+///
+/// @return nothing
+void Game::logEvent(EventType type, int player, int slot, const std::string &card, const std::string &target,
+                    int value, char trait)
+{
+  if (counters_)
+    counters_->addEvent(type, player, value, trait);
+  if (!events_)
+    return;
+  GameEvent event{type, trait, static_cast<uint8_t>(player), static_cast<int8_t>(slot), round_, value, {}, {}};
+  card.copy(event.card, EVENT_CARD_ID_LENGTH - 1);
+  target.copy(event.target, EVENT_CARD_ID_LENGTH - 1);
+  events_->push(event);
+}
+
 //-----------------------------------------------------------------------------------------------------
 ///
 /// Final phase of the game
 ///
 /// @param game_status status of the game
-/// @param config_file_name name of the configuration file
+/// @param config_file_name name of the configuration file the winner is appended to, empty = not written
 ///
 /// @return nothing
 void Game::endGame(int game_status, std::string config_file_name)
 {
-  std::cout << std::endl
+  *out_ << std::endl
             << getDescWithId("D_BORDER_GAME_END") << std::endl;
   if (game_status == 1 || game_status == 2)
   {
-    std::cout << getDescWithId("D_END_DRAW_CARD") << std::endl;
+    *out_ << getDescWithId("D_END_DRAW_CARD") << std::endl;
   }
   else if (game_status == 3 || game_status == 4 || game_status == 7)
   {
-    std::cout << getDescWithId("D_END_PLAYER_DEFEATED") << std::endl;
+    *out_ << getDescWithId("D_END_PLAYER_DEFEATED") << std::endl;
   }
   else if (game_status == 5 || game_status == 6 || game_status == 8)
   {
-    std::cout << getDescWithId("D_END_MAX_ROUNDS") << std::endl;
+    *out_ << getDescWithId("D_END_MAX_ROUNDS") << std::endl;
   }
 
   std::string winner_str;
@@ -54,8 +147,10 @@ void Game::endGame(int game_status, std::string config_file_name)
     winner_str = "Player " + std::to_string(winner) + " has won! Congratulations!\n";
   }
 
-  std::cout << winner_str;
-  std::cout << getDescWithId("D_BORDER_D") << std::endl;
+  *out_ << winner_str;
+  *out_ << getDescWithId("D_BORDER_D") << std::endl;
+  if (config_file_name.empty())
+    return;
 
   std::ofstream config_file(config_file_name, std::ios::app);
   if (config_file.is_open())
@@ -66,10 +161,26 @@ void Game::endGame(int game_status, std::string config_file_name)
   }
   else
   {
-    std::cout << getInfoWithId("I_FILE_WRITE_FAILED") << std::endl;
+    *out_ << getInfoWithId("I_FILE_WRITE_FAILED") << std::endl;
   }
 }
 
+//-----------------------------------------------------------------------------------------------------
+///
+/// Winner of a finished game
+///
+/// @param game_status status returned by the game, see Game::startRound
+///
+/// @return 1 = player 1, 2 = player 2, 0 = tie
+int Game::winnerFromStatus(int game_status)
+{
+  if (game_status == 1 || game_status == 3 || game_status == 5)
+    return 1;
+  if (game_status == 2 || game_status == 4 || game_status == 6)
+    return 2;
+  return 0;
+}
+
 //-----------------------------------------------------------------------------------------------------
 ///
 /// Starts a new round
@@ -120,11 +231,13 @@ int Game::startRound()
     attacker_ = defender_;
     defender_ = temp;
   }
+  active_player_ = attacker_;
+  logEvent(EventType::ROUND_START, attacker_, -1, "");
 
-  std::cout << std::endl
+  *out_ << std::endl
             << getDescWithId("D_BORDER_D") << std::endl;
-  std::cout << "                                         ROUND " << round_ << std::endl;
-  std::cout << getDescWithId("D_BORDER_D") << std::endl;
+  *out_ << "                                         ROUND " << round_ << std::endl;
+  *out_ << getDescWithId("D_BORDER_D") << std::endl;
 
   // increase mana pool
   if (round_ % 2)
@@ -134,7 +247,7 @@ int Game::startRound()
   }
 
   // print board
-  board_.printBoard(defender_, getDescWithId("D_BORDER_A"), getDescWithId("D_BORDER_B"));
+  board_.printBoard(defender_, getDescWithId("D_BORDER_A"), getDescWithId("D_BORDER_B"), *out_);
 
   // cause: deck empty cant draw card
   //  1 is player 1 wins
@@ -158,228 +271,1400 @@ int Game::startRound()
 ///         getDefenderNumber() = defender loses
 int Game::battlePhase()
 {
-  std::cout << "\n"
+  *out_ << "\n"
             << getDescWithId("D_BORDER_BATTLE_PHASE") << "\n";
-  std::shared_ptr<Creature> attacking_card = nullptr;
-  std::shared_ptr<Creature> defending_card = nullptr;
+  Creature *attacking_card = nullptr;
+  Creature *defending_card = nullptr;
   for (int slot = 0; slot < 7; slot++)
   {
-    std::cout << "---------------------------------------- SLOT " << slot + 1 << " -----------------------------------------\n";
+    *out_ << "---------------------------------------- SLOT " << slot + 1 << " -----------------------------------------\n";
     attacking_card = board_.fetchBattleCard(attacker_, slot);
     defending_card = board_.fetchBattleCard(defender_, slot);
 
     if (attacking_card != nullptr && defending_card == nullptr)
     {
-      std::cout << getInfoWithId("I_DIRECT") << std::endl;
+      *out_ << getInfoWithId("I_DIRECT") << std::endl;
+      logEvent(EventType::DIRECT_ATTACK, attacker_, slot, attacking_card->getCardID(), "",
+               attacking_card->getCurrentAttack());
       getDefender().damagePlayer(attacking_card->getCurrentAttack());
     }
-    else if (attacking_card != nullptr && defending_card != nullptr)
+    else if (attacking_card != nullptr && defending_card != nullptr)
+    {
+      logEvent(EventType::FIGHT, attacker_, slot, attacking_card->getCardID(), defending_card->getCardID());
+      resolvingFight(attacking_card, defending_card);
+      checkCreatureDeaths();
+    }
+
+    if (getAttacker().isDead() && getDefender().isDead())
+    {
+      return 7;
+    }
+    else if (getAttacker().isDead())
+    {
+      return getAttackerNumber();
+    }
+    if (getDefender().isDead())
+    {
+      return getDefenderNumber();
+    }
+  }
+  *out_ << getDescWithId("D_BORDER_BATTLE_END") << std::endl;
+  handleTemporaryCards();
+  offsetCreaturesOnBoard();
+  handleUndyingCards();
+  return 0;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// One creature strikes the other, specialized for the fight traits of the striking creature. Does the
+/// same as resolveFightTraits without looking at the trait hooks.
+///
+/// @param attacking_card striking card
+/// @param defending_card card that is struck
+/// @param defender player of the card that is struck
+///
+/// @return nothing
+template <uint8_t TRAITS> void Game::strike(Creature *attacking_card, Creature *defending_card, int defender)
+{
+  TraitEvent event;
+  event.creature = attacking_card;
+  event.target = defending_card;
+  event.player = 3 - defender;
+  event.value = attacking_card->getCurrentAttack() - defending_card->getCurrentHealth();
+  board_.damageCreature(defending_card, attacking_card->getCurrentAttack());
+
+  if constexpr ((TRAITS & FIGHT_TRAIT_B) != 0)
+    brutalHook(event);
+  if constexpr ((TRAITS & FIGHT_TRAIT_L) != 0)
+    lifestealHook(event);
+  if constexpr ((TRAITS & FIGHT_TRAIT_V) != 0)
+    venomousHook(event);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Resolves a fight, specialized for the fight traits of both creatures: the order of the strikes is
+/// fixed at compile time and only the hooks of the creatures' traits are called. Does the same as
+/// resolveFightGeneric.
+///
+/// @param attacking_card attacking card
+/// @param defending_card defending card
+///
+/// @return nothing
+template <uint8_t ATTACKER, uint8_t DEFENDER>
+void Game::resolveFight(Creature *attacking_card, Creature *defending_card)
+{
+  constexpr bool attacker_first = (ATTACKER & FIGHT_TRAIT_F) != 0;
+  constexpr bool defender_first = (DEFENDER & FIGHT_TRAIT_F) != 0;
+
+  *out_ << getInfoWithId("I_FIGHT") << std::endl;
+  *out_ << getDescWithId("D_ATTACK_1") << std::endl;
+  if constexpr (attacker_first && !defender_first)
+  {
+    *out_ << getInfoWithId("I_FIRST_STRIKE") << std::endl;
+    logEvent(EventType::TRAIT, attacker_, -1, attacking_card->getCardID(), defending_card->getCardID(), 0, 'F');
+    strike<ATTACKER>(attacking_card, defending_card, defender_);
+    if (defending_card->isDead())
+      return;
+    *out_ << getDescWithId("D_ATTACK_2") << std::endl;
+    strike<DEFENDER>(defending_card, attacking_card, attacker_);
+  }
+  else if constexpr (!attacker_first && defender_first)
+  {
+    *out_ << getInfoWithId("I_FIRST_STRIKE") << std::endl;
+    logEvent(EventType::TRAIT, defender_, -1, defending_card->getCardID(), attacking_card->getCardID(), 0, 'F');
+    strike<DEFENDER>(defending_card, attacking_card, attacker_);
+    if (attacking_card->isDead())
+      return;
+    *out_ << getDescWithId("D_ATTACK_2") << std::endl;
+    strike<ATTACKER>(attacking_card, defending_card, defender_);
+  }
+  else
+  {
+    strike<ATTACKER>(attacking_card, defending_card, defender_);
+    *out_ << getDescWithId("D_ATTACK_2") << std::endl;
+    strike<DEFENDER>(defending_card, attacking_card, attacker_);
+  }
+}
+
+typedef void (Game::*FightResolver)(Creature *attacking_card, Creature *defending_card);
+
+template <size_t... INDEX>
+static constexpr std::array<FightResolver, sizeof...(INDEX)> makeFightResolvers(std::index_sequence<INDEX...>)
+{
+  return {&Game::resolveFight<INDEX / FIGHT_TRAIT_COMBINATIONS, INDEX % FIGHT_TRAIT_COMBINATIONS>...};
+}
+
+// index = fight traits of the attacker * FIGHT_TRAIT_COMBINATIONS + fight traits of the defender
+static constexpr std::array<FightResolver, FIGHT_TRAIT_COMBINATIONS * FIGHT_TRAIT_COMBINATIONS> FIGHT_RESOLVERS =
+    makeFightResolvers(std::make_index_sequence<FIGHT_TRAIT_COMBINATIONS * FIGHT_TRAIT_COMBINATIONS>{});
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Resolves the fight between two creatures with the resolver specialized for their fight traits
+///
+/// @param attacking_card attacking card
+/// @param defending_card defending card
+///
+/// @return nothing
+void Game::resolvingFight(Creature *attacking_card, Creature *defending_card)
+{
+  int index = fightTraits(attacking_card->getTraitMask()) * FIGHT_TRAIT_COMBINATIONS +
+              fightTraits(defending_card->getTraitMask());
+  (this->*FIGHT_RESOLVERS[index])(attacking_card, defending_card);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Resolves the fight between two creatures through the trait registry, the reference for the
+/// specialized resolvers
+///
+/// @param attacking_card attacking card
+/// @param defending_card defending card
+///
+/// @return nothing
+void Game::resolveFightGeneric(Creature *attacking_card, Creature *defending_card)
+{
+  *out_ << getInfoWithId("I_FIGHT") << std::endl;
+
+  *out_ << getDescWithId("D_ATTACK_1") << std::endl;
+
+  // FIRST STRIKE CHECK =====================================
+  uint16_t first_strike = TraitRegistry::get().getMask(TraitPhase::FIRST_STRIKE);
+  bool attacker_first = attacking_card->getTraitMask() & first_strike;
+  bool defender_first = defending_card->getTraitMask() & first_strike;
+  if (attacker_first && !defender_first)
+  {
+    *out_ << getInfoWithId("I_FIRST_STRIKE") << std::endl;
+    logEvent(EventType::TRAIT, attacker_, -1, attacking_card->getCardID(), defending_card->getCardID(), 0, 'F');
+    resolveFightTraits(attacking_card, defending_card, defender_);
+    if (!defending_card->isDead())
+    {
+      *out_ << getDescWithId("D_ATTACK_2") << std::endl;
+      resolveFightTraits(defending_card, attacking_card, attacker_);
+    }
+  }
+  else if (!attacker_first && defender_first)
+  {
+    *out_ << getInfoWithId("I_FIRST_STRIKE") << std::endl;
+    logEvent(EventType::TRAIT, defender_, -1, defending_card->getCardID(), attacking_card->getCardID(), 0, 'F');
+    resolveFightTraits(defending_card, attacking_card, attacker_);
+    if (!attacking_card->isDead())
+    {
+      *out_ << getDescWithId("D_ATTACK_2") << std::endl;
+      resolveFightTraits(attacking_card, defending_card, defender_);
+    }
+  }
+  else
+  {
+    resolveFightTraits(attacking_card, defending_card, defender_);
+    *out_ << getDescWithId("D_ATTACK_2") << std::endl;
+    resolveFightTraits(defending_card, attacking_card, attacker_);
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Resolves the fight traits
+///
+/// @param attacking_card attacking card
+/// @param defending_card defending card
+/// @param defender defending player
+///
+/// @return nothing
+void Game::resolveFightTraits(Creature *attacking_card, Creature *defending_card, int defender)
+{
+  TraitEvent event;
+  event.creature = attacking_card;
+  event.target = defending_card;
+  event.player = 3 - defender;
+  event.value = attacking_card->getCurrentAttack() - defending_card->getCurrentHealth(); // brutal
+  board_.damageCreature(defending_card, attacking_card->getCurrentAttack());
+
+  const TraitRegistry &traits = TraitRegistry::get();
+  if (attacking_card->getTraitMask() & traits.getMask(TraitPhase::ATTACK))
+    traits.dispatch(*this, TraitPhase::ATTACK, &event, 1);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Trait::B: deals the excess damage of a kill to the defending player
+///
+/// @param event attacking creature, defending creature and excess damage
+///
+/// @return nothing
+void Game::brutalHook(TraitEvent &event)
+{
+  if (!event.target->isDead())
+    return;
+  int damage = event.value < 0 ? 0 : event.value;
+  *out_ << getInfoWithId("I_BRUTAL") << std::endl;
+  logEvent(EventType::TRAIT, event.player, -1, event.creature->getCardID(), event.target->getCardID(), damage, 'B');
+  players_[2 - event.player].damagePlayer(damage);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Trait::L: the attacking creature heals 2
+///
+/// @param event attacking creature
+///
+/// @return nothing
+void Game::lifestealHook(TraitEvent &event)
+{
+  if (event.creature->getCurrentAttack() <= 0)
+    return;
+  *out_ << getInfoWithId("I_LIFESTEAL") << std::endl;
+  logEvent(EventType::TRAIT, event.player, -1, event.creature->getCardID(), "", 2, 'L');
+  board_.setCreatureHealth(event.creature, event.creature->getCurrentHealth() + 2);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Trait::V: the defending creature is poisoned
+///
+/// @param event attacking creature and defending creature
+///
+/// @return nothing
+void Game::venomousHook(TraitEvent &event)
+{
+  if (event.creature->getCurrentAttack() <= 0)
+    return;
+  *out_ << getInfoWithId("I_VENOMOUS") << std::endl;
+  logEvent(EventType::TRAIT, event.player, -1, event.creature->getCardID(), event.target->getCardID(), 0, 'V');
+  event.target->addTrait(Trait::P);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Plays every combination of fight traits with a few attack and health values through the specialized
+/// resolver and through resolveFightGeneric on copies of the game, and compares the messages, both
+/// creatures and the health of both players
+///
+/// @param report stream the differences are printed to
+///
+/// @return number of fights that differ
+int Game::checkFightResolvers(std::ostream &report) const
+{
+  // attack and health of the attacking card, attack and health of the defending card
+  static const int STATS[][4] = {{3, 2, 2, 3}, {3, 4, 2, 2}, {0, 3, 2, 2}, {5, 1, 4, 1},
+                                 {2, 4, 2, 4}, {1, 1, 0, 5}, {6, 3, 3, 2}};
+  static const char LETTERS[] = "BFLV";
+  const Trait TRAITS[] = {Trait::B, Trait::F, Trait::L, Trait::V};
+
+  const CreaturePrototype *prototype = Creature::findPrototype(creature_codebook_->front()->getCardID());
+  int differences = 0;
+  for (int index = 0; index < FIGHT_TRAIT_COMBINATIONS * FIGHT_TRAIT_COMBINATIONS; index++)
+  {
+    uint16_t traits[2] = {0, 0};
+    for (int trait = 0; trait < 4; trait++)
+    {
+      if (index / FIGHT_TRAIT_COMBINATIONS & (1 << trait))
+        traits[0] |= traitBit(TRAITS[trait]);
+      if (index % FIGHT_TRAIT_COMBINATIONS & (1 << trait))
+        traits[1] |= traitBit(TRAITS[trait]);
+    }
+    for (const auto &stats : STATS)
+    {
+      Game games[2] = {Game(*this), Game(*this)};
+      std::ostringstream messages[2];
+      std::vector<Creature> cards;
+      cards.reserve(4);
+      for (int run = 0; run < 2; run++)
+      {
+        games[run].setOutputStream(&messages[run]);
+        for (int card = 0; card < 2; card++)
+        {
+          Creature &creature = cards.emplace_back(prototype);
+          creature.setCurrentAttack(stats[card * 2]);
+          creature.setCurrentHealth(stats[card * 2 + 1]);
+          creature.setTraitMask(traits[card]);
+        }
+      }
+      games[0].resolveFightGeneric(&cards[0], &cards[1]);
+      games[1].resolvingFight(&cards[2], &cards[3]);
+
+      bool same = messages[0].str() == messages[1].str();
+      for (int card = 0; card < 2; card++)
+        same = same && cards[card].getCurrentAttack() == cards[card + 2].getCurrentAttack() &&
+               cards[card].getCurrentHealth() == cards[card + 2].getCurrentHealth() &&
+               cards[card].getTraitMask() == cards[card + 2].getTraitMask();
+      for (int player = 0; player < 2; player++)
+        same = same && games[0].players_[player].getHealth() == games[1].players_[player].getHealth();
+      if (same)
+        continue;
+
+      differences++;
+      report << "Fight resolver differs: attacker ";
+      for (int card = 0; card < 2; card++)
+      {
+        report << (card ? " against defender " : "");
+        for (int trait = 0; trait < 4; trait++)
+        {
+          if (traits[card] & traitBit(TRAITS[trait]))
+            report << LETTERS[trait];
+        }
+        report << "(" << stats[card * 2] << "/" << stats[card * 2 + 1] << ")";
+      }
+      report << std::endl;
+    }
+  }
+  return differences;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Runs the DEATH hooks on the creatures in the graveyards, Trait::U places them back on the field
+///
+/// @return nothing
+void Game::handleUndyingCards()
+{
+  const TraitRegistry &traits = TraitRegistry::get();
+  uint16_t mask = traits.getMask(TraitPhase::DEATH);
+  for (int player = 0; player < 2; player++)
+  {
+    std::vector<TraitEvent> events;
+    const std::vector<std::shared_ptr<Creature>> &graveyard = players_[player].getGraveyard();
+    for (unsigned long index = 0; index < graveyard.size(); index++)
+    {
+      if (!(graveyard[index]->getTraitMask() & mask))
+        continue;
+      TraitEvent &event = events.emplace_back();
+      event.creature = graveyard[index].get();
+      event.player = player + 1;
+      event.slot = static_cast<int>(index);
+    }
+    if (events.empty())
+      continue;
+    traits.dispatch(*this, TraitPhase::DEATH, events.data(), static_cast<int>(events.size()));
+
+    std::vector<unsigned long> creatures_to_remove_indexes;
+    for (const TraitEvent &event : events)
+    {
+      if (event.removed)
+        creatures_to_remove_indexes.push_back(static_cast<unsigned long>(event.slot));
+    }
+    players_[player].removeUndyingFromGraveyard(creatures_to_remove_indexes);
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Trait::U: the creature is placed back on the field if there is a free slot and loses Undying
+///
+/// @param event creature and its graveyard index
+///
+/// @return nothing
+void Game::undyingHook(TraitEvent &event)
+{
+  if (board_.areAllFieldsFull(event.player))
+    return;
+  const std::shared_ptr<Creature> &card = players_[event.player - 1].getGraveyard().at(event.slot);
+  card->resetAttributes();
+  card->removeUndying();
+  card->setRoundPlacement(round_);
+  board_.placeCard(card, event.player, -1);
+  event.removed = true;
+  *out_ << getInfoWithId("I_UNDYING") << std::endl;
+  logEvent(EventType::UNDYING, event.player, -1, card->getCardID());
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Runs the END_OF_BATTLE hooks on the creatures on the board, the battle zones first. Trait::T removes
+/// them from the board.
+///
+/// @return nothing
+void Game::handleTemporaryCards()
+{
+  const TraitRegistry &traits = TraitRegistry::get();
+  uint16_t mask = traits.getMask(TraitPhase::END_OF_BATTLE);
+  TraitEvent events[TRAIT_BOARD_EVENT_LIMIT];
+  int count = 0;
+  for (int battle = 1; battle >= 0; battle--)
+  {
+    for (int player = 1; player <= 2; player++)
+    {
+      for (int slot = 0; slot < 7; slot++)
+      {
+        Creature *card = battle ? board_.fetchBattleCard(player, slot) : board_.fetchFieldCard(player, slot);
+        if (card == nullptr || !(card->getTraitMask() & mask))
+          continue;
+        events[count].creature = card;
+        events[count].player = player;
+        events[count].slot = slot;
+        events[count].battle = battle;
+        count++;
+      }
+    }
+  }
+  traits.dispatch(*this, TraitPhase::END_OF_BATTLE, events, count);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Trait::T: the creature is moved to the graveyard
+///
+/// @param event creature and its slot
+///
+/// @return nothing
+void Game::temporaryHook(TraitEvent &event)
+{
+  *out_ << getInfoWithId("I_TEMPORARY") << std::endl;
+  logEvent(EventType::TEMPORARY, event.player, event.slot, event.creature->getCardID());
+  players_[event.player - 1].addCardToGraveyard(event.battle ? board_.takeBattleCard(event.player, event.slot)
+                                                             : board_.takeFieldCard(event.player, event.slot));
+  event.removed = true;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Removes creatures from the battle and places them back on the field if possible
+///
+/// @return nothing
+void Game::offsetCreaturesOnBoard()
+{
+  for (int player = 0; player < 2; player++)
+  {
+    for (unsigned occupied = board_.getBattleOccupancy(player + 1); occupied; occupied &= occupied - 1)
+    {
+      int slot = std::countr_zero(occupied);
+      if (!board_.areAllFieldsFull(player + 1))
+        board_.placeCard(board_.takeBattleCard(player + 1, slot), player + 1, -1);
+      else
+        players_[player].addCardToGraveyard(board_.takeBattleCard(player + 1, slot));
+    }
+  }
+}
+
+Player &Game::getAttacker()
+{
+  return players_[attacker_ - 1];
+}
+
+Player &Game::getDefender()
+{
+  return players_[defender_ - 1];
+}
+
+Player &Game::getActivePlayer()
+{
+  return players_[active_player_ - 1];
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Finishes the phase of the active player. After the attacker the defender gets to play, after the
+/// defender the battle is fought and the next round is started.
+///
+/// @return 0 = game continues, otherwise the game status as returned by startRound()
+int Game::finishPhase()
+{
+  setRedrawFalse(getActivePlayer());
+  applyTraits(active_player_);
+  printBoard();
+
+  if (active_player_ == attacker_)
+  {
+    active_player_ = defender_;
+    return 0;
+  }
+
+  int battle_status = battlePhase();
+  if (battle_status == 1)
+    return 4;
+  else if (battle_status == 2)
+    return 3;
+  else if (battle_status == 7)
+    return 7;
+
+  return startRound();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Plays a single action for the active player
+///
+/// @param command action to play, Command::DONE finishes the phase
+///
+/// @return 0 = game continues, otherwise the game status as returned by startRound()
+int Game::applyAction(Command command)
+{
+  AllocationSnapshot allocations_before;
+  int action_round = round_;
+  if (allocations_)
+    allocations_before = AllocationTracker::threadSnapshot();
+
+  int game_status = 0;
+  if (command.isDone())
+    game_status = finishPhase();
+  else
+    processCommand(getActivePlayer(), command);
+
+  if (game_status)
+    logEvent(EventType::GAME_END, winnerFromStatus(game_status), -1, "", "", game_status);
+  if (allocations_)
+    allocations_->addAction(command.getType(), action_round,
+                            (AllocationTracker::threadSnapshot() - allocations_before).total());
+  return game_status;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Generates every action the active player can legally play in the current position. Commands that
+/// do not change the game (help, status, ...) are left out.
+///
+/// @return legal actions, Command::DONE is always the last one
+std::vector<Command> Game::generateActions() const
+{
+  AllocationScope scope(AllocationSubsystem::COMMANDS);
+  std::vector<Command> actions;
+  const Player &player = players_[active_player_ - 1];
+  const Player &opponent = players_[active_player_ == 1 ? 1 : 0];
+  std::vector<std::string> seen_ids;
+
+  for (const auto &card : player.getHand())
+  {
+    std::string card_id = card->getCardID();
+    if (std::find(seen_ids.begin(), seen_ids.end(), card_id) != seen_ids.end())
+      continue;
+    seen_ids.push_back(card_id);
+
+    const Creature *creature = dynamic_cast<const Creature *>(card.get());
+    if (creature)
+    {
+      if (creature->getManaCost() > player.getMana())
+        continue;
+      for (unsigned free = ~board_.getFieldOccupancy(active_player_) & BOARD_FULL_ZONE; free; free &= free - 1)
+      {
+        int slot = std::countr_zero(free);
+        actions.emplace_back(CommandType::CREATURE, std::vector<std::string>{card_id, "f" + std::to_string(slot + 1)});
+      }
+      continue;
+    }
+
+    const Spell *spell = static_cast<const Spell *>(card.get());
+    SpellTarget spell_target = spell->getTarget();
+    if (spell_target == SpellTarget::NONE)
+    {
+      if (spell->getRequiredMana() <= player.getMana())
+        actions.emplace_back(CommandType::SPELL, std::vector<std::string>{card_id});
+    }
+    else if (spell_target == SpellTarget::CREATURE)
+    {
+      for (int side = 0; side < 2; side++)
+      {
+        int target_player = side == 0 ? player.getPlayerNumber() : opponent.getPlayerNumber();
+        std::string prefix = side == 0 ? "" : "o";
+        unsigned occupied = board_.getFieldOccupancy(target_player) | board_.getBattleOccupancy(target_player);
+        for (; occupied; occupied &= occupied - 1)
+        {
+          int slot = std::countr_zero(occupied);
+          const Creature *target = board_.fetchFieldCard(target_player, slot);
+          if (target != nullptr && spell->getRequiredMana() <= player.getMana())
+            actions.emplace_back(CommandType::SPELL,
+                                 std::vector<std::string>{card_id, prefix + "f" + std::to_string(slot + 1)});
+          target = board_.fetchBattleCard(target_player, slot);
+          if (target != nullptr && spell->getRequiredMana() <= player.getMana())
+            actions.emplace_back(CommandType::SPELL,
+                                 std::vector<std::string>{card_id, prefix + "b" + std::to_string(slot + 1)});
+        }
+      }
+    }
+    else if (spell_target == SpellTarget::GRAVEYARD)
+    {
+      std::vector<std::string> seen_graveyard_ids;
+      for (const auto &target : player.getGraveyard())
+      {
+        std::string target_id = target->getCardID();
+        if (std::find(seen_graveyard_ids.begin(), seen_graveyard_ids.end(), target_id) != seen_graveyard_ids.end())
+          continue;
+        seen_graveyard_ids.push_back(target_id);
+        if (spell->getRequiredMana() <= player.getMana())
+          actions.emplace_back(CommandType::SPELL, std::vector<std::string>{card_id, target_id});
+      }
+    }
+  }
+
+  unsigned free_battle_slots = ~board_.getBattleOccupancy(active_player_) & BOARD_FULL_ZONE;
+  for (unsigned occupied = board_.getFieldOccupancy(active_player_); occupied; occupied &= occupied - 1)
+  {
+    int field_slot = std::countr_zero(occupied);
+    const Creature *creature = board_.fetchFieldCard(active_player_, field_slot);
+    if (creature->getRoundPlacement() == round_ && !creature->checkTrait(Trait::H))
+      continue;
+    for (unsigned free = free_battle_slots; free; free &= free - 1)
+    {
+      int battle_slot = std::countr_zero(free);
+      actions.emplace_back(CommandType::BATTLE, std::vector<std::string>{"f" + std::to_string(field_slot + 1),
+                                                                         "b" + std::to_string(battle_slot + 1)});
+    }
+  }
+
+  if (player.getRedrawStatus() && player.getHandSize() >= 2)
+    actions.emplace_back(CommandType::REDRAW);
+
+  actions.emplace_back(CommandType::DONE);
+  return actions;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Turns the game into one possible version of it as seen by the observer: the opponent's hand and
+/// deck are dealt again from the same cards and the observer's own deck is shuffled. The cards in those
+/// zones together are known from the deck lists and the cards played so far, only their order is not.
+///
+/// @param observer player number of the observing player
+/// @param generator random number generator
+///
+/// @return nothing
+void Game::determinize(int observer, std::mt19937_64 &generator)
+{
+  players_[observer - 1].shuffleHiddenCards(generator, false);
+  players_[observer == 1 ? 1 : 0].shuffleHiddenCards(generator, true);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Mixes a value into a position hash
+///
+/// @param hash hash to update
+/// @param value value to mix in
+///
+/// @return nothing
+static void hashCombine(uint64_t &hash, uint64_t value)
+{
+  hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Mixes a string into a position hash
+///
+/// @param hash hash to update
+/// @param text string to mix in
+///
+/// @return nothing
+static void hashCombine(uint64_t &hash, const std::string &text)
+{
+  uint64_t text_hash = 0xcbf29ce484222325ULL;
+  for (unsigned char letter : text)
+  {
+    text_hash = (text_hash ^ letter) * 0x100000001b3ULL;
+  }
+  hashCombine(hash, text_hash);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Mixes the state of a card into a position hash
+///
+/// @param hash hash to update
+/// @param card card to mix in, nullptr = empty slot
+/// @param round current round, only used for the creatures on the board
+///
+/// @return nothing
+static void hashCard(uint64_t &hash, const Card *card, int round)
+{
+  if (card == nullptr)
+  {
+    hashCombine(hash, 0);
+    return;
+  }
+  hashCombine(hash, card->getCardID());
+
+  const Creature *creature = dynamic_cast<const Creature *>(card);
+  if (creature == nullptr)
+    return;
+  hashCombine(hash, creature->getCurrentAttack());
+  hashCombine(hash, creature->getCurrentHealth());
+  for (int trait = Trait::NON; trait <= Trait::V; trait++)
+  {
+    if (creature->checkTrait(static_cast<Trait>(trait)))
+      hashCombine(hash, trait);
+  }
+  hashCombine(hash, round > 0 && creature->getRoundPlacement() == round);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Mixes cards whose order is hidden into a position hash, so every order gives the same hash
+///
+/// @param hash hash to update
+/// @param first first group of cards
+/// @param second second group of cards, dealt from the same hidden cards as the first
+///
+/// @return nothing
+static void hashHiddenCards(uint64_t &hash, const std::vector<std::shared_ptr<Card>> &first,
+                            const std::vector<std::shared_ptr<Card>> &second)
+{
+  uint64_t cards = 0;
+  for (const auto *group : {&first, &second})
+  {
+    for (const auto &card : *group)
+    {
+      uint64_t card_hash = 0;
+      hashCard(card_hash, card.get(), 0);
+      cards += card_hash;
+    }
+  }
+  hashCombine(hash, cards);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Computes a hash of the position as a player sees it: the order of its own deck and the opponent's hand
+/// and deck are hidden, only which cards they hold is known
+///
+/// @param observer player whose view is hashed, 0 = everything is visible
+///
+/// @return position hash
+uint64_t Game::hashPosition(int observer) const
+{
+  uint64_t hash = 0;
+  hashCombine(hash, round_);
+  hashCombine(hash, max_rounds_);
+  hashCombine(hash, attacker_);
+  hashCombine(hash, active_player_);
+
+  for (const auto &player : players_)
+  {
+    hashCombine(hash, player.getHealth());
+    hashCombine(hash, player.getMana());
+    hashCombine(hash, player.getManaPool());
+    hashCombine(hash, player.getRedrawStatus());
+    hashCombine(hash, player.getHand().size());
+    bool own = player.getPlayerNumber() == observer;
+    if (!observer || own)
+    {
+      for (const auto &card : player.getHand())
+        hashCard(hash, card.get(), 0);
+    }
+    hashCombine(hash, player.getDeck().size());
+    if (!observer)
+    {
+      for (const auto &card : player.getDeck())
+        hashCard(hash, card.get(), 0);
+    }
+    else if (own)
+      hashHiddenCards(hash, player.getDeck(), {});
+    else
+      hashHiddenCards(hash, player.getHand(), player.getDeck());
+    hashCombine(hash, player.getGraveyard().size());
+    for (const auto &card : player.getGraveyard())
+      hashCard(hash, card.get(), 0);
+  }
+
+  for (int player = 1; player <= 2; player++)
+  {
+    for (int slot = 0; slot < 7; slot++)
+    {
+      hashCard(hash, board_.fetchFieldCard(player, slot), round_);
+      hashCard(hash, board_.fetchBattleCard(player, slot), round_);
+    }
+  }
+  return hash;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Computes a hash of everything that influences how the game continues from here: both players'
+/// health, mana, hand, deck and graveyard, the board, the round and whose turn it is
+///
+/// @return position hash
+uint64_t Game::positionHash() const
+{
+  return hashPosition(0);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Computes a hash of what a player can see: everything of positionHash except the order of its own
+/// deck and the opponent's hand and deck. Positions that only differ in hidden cards get the same hash.
+///
+/// @param observer player whose view is hashed
+///
+/// @return visible position hash
+uint64_t Game::visibleHash(int observer) const
+{
+  return hashPosition(observer);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Writes a card as its index in the codebook (creatures first, then spells). A creature is followed by
+/// a flag byte and only the values that differ from its prototype.
+///
+/// @param writer buffer of the saved game
+/// @param card card to write
+/// @param on_board true = the round the creature was placed in is written as well
+///
+/// @return nothing
+void Game::writeCard(StateWriter &writer, const Card *card, bool on_board) const
+{
+  const std::string card_id = card->getCardID();
+  uint64_t index = 0;
+  while (index < creature_codebook_->size() && (*creature_codebook_)[index]->getCardID() != card_id)
+    index++;
+  if (index == creature_codebook_->size())
+  {
+    uint64_t spell = 0;
+    while (spell < spell_codebook_->size() && (*spell_codebook_)[spell]->getCardID() != card_id)
+      spell++;
+    index += spell;
+  }
+  writer.writeUnsigned(index);
+
+  const Creature *creature = dynamic_cast<const Creature *>(card);
+  if (creature == nullptr)
+    return;
+
+  uint8_t flags = 0;
+  if (creature->getCurrentAttack() != creature->getBaseAttack())
+    flags |= 1;
+  if (creature->getCurrentHealth() != creature->getBaseHealth())
+    flags |= 2;
+  if (creature->getTraitMask() != creature->getBaseTraitMask())
+    flags |= 4;
+  writer.writeByte(flags);
+
+  if (flags & 1)
+    writer.writeSigned(creature->getCurrentAttack() - creature->getBaseAttack());
+  if (flags & 2)
+    writer.writeSigned(creature->getCurrentHealth() - creature->getBaseHealth());
+  if (flags & 4)
+    writer.writeUnsigned(creature->getTraitMask());
+  if (on_board)
+    writer.writeSigned(creature->getRoundPlacement());
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Reads a card written by writeCard and creates it from its prototype
+///
+/// @param reader buffer of the saved game
+/// @param on_board true = the round the creature was placed in follows
+///
+/// @return new card, nullptr = invalid card
+std::shared_ptr<Card> Game::readCard(StateReader &reader, bool on_board) const
+{
+  uint64_t index = reader.readUnsigned();
+  std::string card_id;
+  if (index < creature_codebook_->size())
+    card_id = (*creature_codebook_)[index]->getCardID();
+  else if (index - creature_codebook_->size() < spell_codebook_->size())
+    card_id = (*spell_codebook_)[index - creature_codebook_->size()]->getCardID();
+  else
+    return nullptr;
+
+  std::shared_ptr<Card> card = Card::createCardFromID(card_id, arena_);
+  if (card == nullptr)
+    return nullptr;
+
+  Creature *creature = dynamic_cast<Creature *>(card.get());
+  if (creature == nullptr)
+    return on_board ? nullptr : card;
+
+  uint8_t flags = reader.readByte();
+  if (flags & 1)
+    creature->setCurrentAttack(creature->getBaseAttack() + static_cast<int>(reader.readSigned()));
+  if (flags & 2)
+    creature->setCurrentHealth(creature->getBaseHealth() + static_cast<int>(reader.readSigned()));
+  if (flags & 4)
+  {
+    uint64_t mask = reader.readUnsigned();
+    creature->setTraitMask(static_cast<uint16_t>(mask & (traitBit(Trait::V) * 2 - 1)));
+  }
+  creature->setRoundPlacement(on_board ? static_cast<int>(reader.readSigned()) : 0);
+  return card;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Saves the complete state of the game in a compact binary form: the round, who is attacking and who
+/// is to move, both players with their hand, deck and graveyard in order, and the board. Cards are
+/// stored as codebook indices plus the values that differ from the prototype, so a saved game takes a
+/// few hundred bytes. Messages and codebooks are not saved, they come from the config files; the checksum
+/// of the codebook is stored, so the indices are never read with another codebook.
+///
+/// @return saved game
+std::vector<uint8_t> Game::saveState() const
+{
+  StateWriter writer;
+  writer.writeText(GAME_STATE_MAGIC);
+  writer.writeByte(GAME_STATE_VERSION);
+  writer.writeUnsigned(CardCodebook::getLoadedChecksum());
+  writer.writeUnsigned(round_);
+  writer.writeUnsigned(max_rounds_);
+  writer.writeUnsigned(attacker_);
+  writer.writeUnsigned(active_player_);
+
+  for (const auto &player : players_)
+  {
+    writer.writeSigned(player.getHealth());
+    writer.writeSigned(player.getMana());
+    writer.writeUnsigned(player.getManaPool());
+    writer.writeByte(player.getRedrawStatus());
+    writer.writeUnsigned(player.getHand().size());
+    for (const auto &card : player.getHand())
+      writeCard(writer, card.get(), false);
+    writer.writeUnsigned(player.getDeck().size());
+    for (const auto &card : player.getDeck())
+      writeCard(writer, card.get(), false);
+    writer.writeUnsigned(player.getGraveyard().size());
+    for (const auto &creature : player.getGraveyard())
+      writeCard(writer, creature.get(), false);
+  }
+
+  for (int player = 1; player <= 2; player++)
+  {
+    uint8_t battle = 0;
+    uint8_t field = 0;
+    for (int slot = 0; slot < 7; slot++)
+    {
+      battle |= (board_.fetchBattleCard(player, slot) != nullptr) << slot;
+      field |= (board_.fetchFieldCard(player, slot) != nullptr) << slot;
+    }
+    writer.writeByte(battle);
+    writer.writeByte(field);
+    for (int slot = 0; slot < 7; slot++)
+    {
+      if (battle & (1 << slot))
+        writeCard(writer, board_.fetchBattleCard(player, slot), true);
+    }
+    for (int slot = 0; slot < 7; slot++)
+    {
+      if (field & (1 << slot))
+        writeCard(writer, board_.fetchFieldCard(player, slot), true);
+    }
+  }
+  return writer.getBytes();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Replaces the state of the game with a state saved by saveState. The game is only changed if the
+/// whole saved game is valid.
+///
+/// @param state saved game
+///
+/// @return true = restored, false = invalid data, a different version of the format or another codebook
+bool Game::restoreState(const std::vector<uint8_t> &state)
+{
+  StateReader reader(state.data(), state.size());
+  if (!reader.readText(GAME_STATE_MAGIC) || reader.readByte() != GAME_STATE_VERSION)
+    return false;
+  if (reader.readUnsigned() != CardCodebook::getLoadedChecksum())
+    return false;
+
+  int round = static_cast<int>(reader.readUnsigned());
+  int max_rounds = static_cast<int>(reader.readUnsigned());
+  int attacker = static_cast<int>(reader.readUnsigned());
+  int active_player = static_cast<int>(reader.readUnsigned());
+  if ((attacker != 1 && attacker != 2) || (active_player != 1 && active_player != 2))
+    return false;
+
+  std::vector<Player> players;
+  for (int number = 1; number <= 2; number++)
+  {
+    int health = static_cast<int>(reader.readSigned());
+    int mana = static_cast<int>(reader.readSigned());
+    int mana_pool = static_cast<int>(reader.readUnsigned());
+    Player player(number, mana, health, mana_pool);
+    if (!reader.readByte())
+      player.setRedrawToFalse();
+
+    uint64_t count = reader.readUnsigned();
+    for (uint64_t index = 0; index < count && !reader.isFailed(); index++)
+    {
+      std::shared_ptr<Card> card = readCard(reader, false);
+      if (card == nullptr)
+        return false;
+      player.addCardToHand(card);
+    }
+    count = reader.readUnsigned();
+    for (uint64_t index = 0; index < count && !reader.isFailed(); index++)
     {
-      resolvingFight(attacking_card, defending_card);
-      checkCreatureDeaths();
+      std::shared_ptr<Card> card = readCard(reader, false);
+      if (card == nullptr)
+        return false;
+      player.addCardToDeck(card);
     }
-
-    if (getAttacker().isDead() && getDefender().isDead())
+    count = reader.readUnsigned();
+    std::vector<std::shared_ptr<Creature>> graveyard;
+    for (uint64_t index = 0; index < count && !reader.isFailed(); index++)
     {
-      return 7;
+      std::shared_ptr<Creature> creature = std::dynamic_pointer_cast<Creature>(readCard(reader, false));
+      if (creature == nullptr)
+        return false;
+      graveyard.push_back(creature);
     }
-    else if (getAttacker().isDead())
+    // cards are added to the top of the graveyard
+    for (auto creature = graveyard.rbegin(); creature != graveyard.rend(); ++creature)
+      player.addCardToGraveyard(*creature);
+    players.push_back(player);
+  }
+
+  Board board;
+  for (int player = 1; player <= 2; player++)
+  {
+    uint8_t battle = reader.readByte();
+    uint8_t field = reader.readByte();
+    // the battle zone comes first, placing a creature there clears the field slot of the same number
+    for (int slot = 0; slot < 7; slot++)
     {
-      return getAttackerNumber();
+      if (!(battle & (1 << slot)))
+        continue;
+      std::shared_ptr<Creature> creature = std::dynamic_pointer_cast<Creature>(readCard(reader, true));
+      if (creature == nullptr)
+        return false;
+      board.placeCardInBattle(creature, player, slot, slot);
     }
-    if (getDefender().isDead())
+    for (int slot = 0; slot < 7; slot++)
     {
-      return getDefenderNumber();
+      if (!(field & (1 << slot)))
+        continue;
+      std::shared_ptr<Creature> creature = std::dynamic_pointer_cast<Creature>(readCard(reader, true));
+      if (creature == nullptr)
+        return false;
+      board.placeCard(creature, player, slot);
     }
   }
-  std::cout << getDescWithId("D_BORDER_BATTLE_END") << std::endl;
-  handleTemporaryCards();
-  offsetCreaturesOnBoard();
-  handleUndyingCards();
-  return 0;
+  if (reader.isFailed() || !reader.isAtEnd())
+    return false;
+
+  replaceState(players, board, round, max_rounds, attacker, active_player);
+  return true;
 }
 
 //-----------------------------------------------------------------------------------------------------
 ///
-/// Resolves the fight between two creatures
+/// Replaces the state of the game with a restored one, the board printing setting is kept
 ///
-/// @param attacking_card attacking card
-/// @param defending_card defending card
+/// @param players both restored players
+/// @param board restored board
+/// @param round current round
+/// @param max_rounds maximum number of rounds
+/// @param attacker attacking player of the round
+/// @param active_player player to move
 ///
 /// @return nothing
-void Game::resolvingFight(std::shared_ptr<Creature> attacking_card, std::shared_ptr<Creature> defending_card)
+void Game::replaceState(const std::vector<Player> &players, Board &board, int round, int max_rounds, int attacker,
+                        int active_player)
 {
-  std::cout << getInfoWithId("I_FIGHT") << std::endl;
+  if (board.isActive() != board_.isActive())
+    board.toggleActive();
+  players_ = players;
+  board_ = board;
+  round_ = round;
+  max_rounds_ = max_rounds;
+  attacker_ = attacker;
+  defender_ = 3 - attacker;
+  active_player_ = active_player;
+}
 
-  std::cout << getDescWithId("D_ATTACK_1") << std::endl;
+//-----------------------------------------------------------------------------------------------------
+///
+/// Appends a card in position notation: its ID, followed by [attack/health/traits] if a creature
+/// differs from its base values and by @round for creatures on the board
+///
+/// @param notation notation to append to
+/// @param card card to append
+/// @param on_board true = the creature is on the board
+///
+/// @return nothing
+static void appendNotationCard(std::string &notation, const Card *card, bool on_board)
+{
+  notation += card->getCardID();
+  const Creature *creature = dynamic_cast<const Creature *>(card);
+  if (creature == nullptr)
+    return;
 
-  // FIRST STRIKE CHECK =====================================
-  if (attacking_card->checkTrait(Trait::F) && !defending_card->checkTrait(Trait::F))
-  {
-    std::cout << getInfoWithId("I_FIRST_STRIKE") << std::endl;
-    resolveFightTraits(attacking_card, defending_card, defender_);
-    if (!defending_card->isDead())
-    {
-      std::cout << getDescWithId("D_ATTACK_2") << std::endl;
-      resolveFightTraits(defending_card, attacking_card, attacker_);
-    }
-  }
-  else if (!attacking_card->checkTrait(Trait::F) && defending_card->checkTrait(Trait::F))
+  if (creature->getCurrentAttack() != creature->getBaseAttack() ||
+      creature->getCurrentHealth() != creature->getBaseHealth() ||
+      creature->getTraitMask() != creature->getBaseTraitMask())
   {
-    std::cout << getInfoWithId("I_FIRST_STRIKE") << std::endl;
-    resolveFightTraits(defending_card, attacking_card, attacker_);
-    if (!attacking_card->isDead())
+    notation += "[" + std::to_string(creature->getCurrentAttack()) + "/" +
+                std::to_string(creature->getCurrentHealth()) + "/";
+    for (int trait = Trait::NON; trait <= Trait::V; trait++)
     {
-      std::cout << getDescWithId("D_ATTACK_2") << std::endl;
-      resolveFightTraits(attacking_card, defending_card, defender_);
+      if (creature->checkTrait(static_cast<Trait>(trait)))
+        notation += TRAIT_LETTERS[trait];
     }
+    notation += "]";
   }
-  else
-  {
-    resolveFightTraits(attacking_card, defending_card, defender_);
-    std::cout << getDescWithId("D_ATTACK_2") << std::endl;
-    resolveFightTraits(defending_card, attacking_card, attacker_);
-  }
+  if (on_board)
+    notation += "@" + std::to_string(creature->getRoundPlacement());
 }
 
 //-----------------------------------------------------------------------------------------------------
 ///
-/// Resolves the fight traits
+/// Appends a list of cards in position notation, separated by commas, "-" = no cards
 ///
-/// @param attacking_card attacking card
-/// @param defending_card defending card
-/// @param defender defending player
+/// @param notation notation to append to
+/// @param cards cards to append
 ///
 /// @return nothing
-void Game::resolveFightTraits(std::shared_ptr<Creature> attacking_card, std::shared_ptr<Creature> defending_card, int defender)
+template <typename CardType>
+static void appendNotationList(std::string &notation, const std::vector<std::shared_ptr<CardType>> &cards)
 {
-  int excess_damage = attacking_card->getCurrentAttack() - defending_card->getCurrentHealth(); // brutal
-  defending_card->damageCreature(attacking_card->getCurrentAttack());
-
-  // BRUTAL
-  if (attacking_card->checkTrait(Trait::B) && defending_card->isDead())
+  if (cards.empty())
+    notation += "-";
+  for (unsigned long index = 0; index < cards.size(); index++)
   {
-    std::cout << getInfoWithId("I_BRUTAL") << std::endl;
-    players_[defender - 1].damagePlayer(excess_damage < 0 ? 0 : excess_damage);
-  }
-  // LIFESTEAL
-  if (attacking_card->checkTrait(Trait::L) && attacking_card->getCurrentAttack() > 0)
-  {
-    std::cout << getInfoWithId("I_LIFESTEAL") << std::endl;
-    attacking_card->increaseCurrentHealth(2);
-  }
-  // VENOMOUS
-  if (attacking_card->checkTrait(Trait::V) && attacking_card->getCurrentAttack() > 0)
-  {
-    std::cout << getInfoWithId("I_VENOMOUS") << std::endl;
-    defending_card->addTrait(Trait::P);
+    if (index)
+      notation += ",";
+    appendNotationCard(notation, cards[index].get(), false);
   }
 }
 
 //-----------------------------------------------------------------------------------------------------
 ///
-/// Checks if a creature has Trait::U, if so, it is placed back on the field
+/// Describes the position in one line, in the spirit of the FEN notation of chess. The fields are
+/// separated by spaces:
 ///
-/// @return nothing
-void Game::handleUndyingCards()
+///   <round>/<max rounds> <attacker><player to move>
+///   then for player 1 and player 2:
+///   <health>/<mana>/<mana pool>/<r = can redraw, - = can not> <hand> <deck> <graveyard>
+///   <battle zone> <field zone>
+///
+/// Hand, deck (top card first) and graveyard are card lists. A zone lists its 7 slots separated by
+/// commas, a number stands for that many empty slots. A card is its ID, followed by
+/// [attack/health/traits] if a creature differs from its base values and by @round on the board, e.g.
+/// SOLDR[3/2/P]@4.
+///
+/// @return position notation
+std::string Game::toNotation() const
 {
-  std::shared_ptr<Creature> card = nullptr;
-  for (int player = 0; player < 2; player++)
-  {
-    std::vector<unsigned long> creatures_to_remove_indexes;
-    for (unsigned long index = 0; index < players_[player].getGraveyard().size(); index++)
+  std::string notation = std::to_string(round_) + "/" + std::to_string(max_rounds_) + " " +
+                         std::to_string(attacker_) + std::to_string(active_player_);
+  for (int player = 1; player <= 2; player++)
+  {
+    const Player &state = players_[player - 1];
+    notation += " " + std::to_string(state.getHealth()) + "/" + std::to_string(state.getMana()) + "/" +
+                std::to_string(state.getManaPool()) + "/" + (state.getRedrawStatus() ? "r" : "-");
+    notation += " ";
+    appendNotationList(notation, state.getHand());
+    notation += " ";
+    appendNotationList(notation, state.getDeck());
+    notation += " ";
+    appendNotationList(notation, state.getGraveyard());
+
+    for (int zone = 0; zone < 2; zone++)
     {
-      card = players_[player].getGraveyard().at(index);
-      if (card->checkTrait(Trait::U))
+      notation += " ";
+      int empty_slots = 0;
+      bool first = true;
+      for (int slot = 0; slot < 7; slot++)
       {
-        if (!board_.areAllFieldsFull(player + 1))
+        const Creature *creature =
+            zone == 0 ? board_.fetchBattleCard(player, slot) : board_.fetchFieldCard(player, slot);
+        if (creature == nullptr)
+        {
+          empty_slots++;
+          continue;
+        }
+        if (empty_slots)
         {
-          card->resetAttributes();
-          card->removeUndying();
-          card->setRoundPlacement(round_);
-          board_.placeCard(card, player, -1);
-          creatures_to_remove_indexes.push_back(index);
-          std::cout << getInfoWithId("I_UNDYING") << std::endl;
+          notation += (first ? "" : ",") + std::to_string(empty_slots);
+          first = false;
+          empty_slots = 0;
         }
+        notation += first ? "" : ",";
+        first = false;
+        appendNotationCard(notation, creature, true);
       }
+      if (empty_slots)
+        notation += (first ? "" : ",") + std::to_string(empty_slots);
     }
-    players_[player].removeUndyingFromGraveyard(creatures_to_remove_indexes);
   }
+  return notation;
 }
 
 //-----------------------------------------------------------------------------------------------------
 ///
-/// Checks if a creature has Trait::T, if so, it is removed from the board
+/// Splits text at a separator
 ///
-/// @return nothing
-void Game::handleTemporaryCards()
+/// @param text text to split
+/// @param separator separating character
+///
+/// @return parts of the text, they point into the text
+static std::vector<std::string_view> splitNotation(std::string_view text, char separator)
 {
-  std::shared_ptr<Creature> card = nullptr;
-  for (int player = 0; player < 2; player++)
+  std::vector<std::string_view> parts;
+  while (true)
   {
-    for (int slot = 0; slot < 7; slot++)
-    {
-      card = board_.fetchBattleCard(player + 1, slot);
-      if (card == nullptr)
-        continue;
-      if (card->checkTrait(Trait::T))
-      {
-        board_.removeCardFromBattle(player + 1, slot);
-        players_[player].addCardToGraveyard(card);
-        std::cout << getInfoWithId("I_TEMPORARY") << std::endl;
-      }
-    }
+    size_t end = text.find(separator);
+    parts.push_back(text.substr(0, end));
+    if (end == std::string_view::npos)
+      return parts;
+    text.remove_prefix(end + 1);
   }
+}
 
-  for (int player = 0; player < 2; player++)
-  {
-    for (int slot = 0; slot < 7; slot++)
+//-----------------------------------------------------------------------------------------------------
+///
+/// Parses a whole field of the notation as a number
+///
+/// @param text field
+/// @param value set to the number
+///
+/// @return true = valid number, false = not a number
+static bool parseNotationNumber(std::string_view text, int &value)
+{
+  const char *end = text.data() + text.size();
+  auto result = std::from_chars(text.data(), end, value);
+  return !text.empty() && result.ec == std::errc() && result.ptr == end;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Parses a card of the position notation and creates it
+///
+/// @param token card in position notation
+/// @param on_board true = the card is on the board, it has to be a creature with @round
+///
+/// @return new card, nullptr = invalid card
+std::shared_ptr<Card> Game::parseNotationCard(std::string_view token, bool on_board) const
+{
+  size_t id_end = token.find_first_of("[@");
+  std::shared_ptr<Card> card = Card::createCardFromID(std::string(token.substr(0, id_end)), arena_);
+  if (card == nullptr)
+    return nullptr;
+  token.remove_prefix(id_end == std::string_view::npos ? token.size() : id_end);
+
+  Creature *creature = dynamic_cast<Creature *>(card.get());
+  if (creature == nullptr)
+    return token.empty() && !on_board ? card : nullptr;
+
+  if (!token.empty() && token.front() == '[')
+  {
+    size_t values_end = token.find(']');
+    if (values_end == std::string_view::npos)
+      return nullptr;
+    std::vector<std::string_view> values = splitNotation(token.substr(1, values_end - 1), '/');
+    int attack = 0;
+    int health = 0;
+    if (values.size() != 3 || !parseNotationNumber(values[0], attack) || !parseNotationNumber(values[1], health))
+      return nullptr;
+    uint16_t traits = 0;
+    for (char letter : values[2])
     {
-      card = board_.fetchFieldCard(player + 1, slot);
-      if (card == nullptr)
-        continue;
-      if (card->checkTrait(Trait::T))
-      {
-        board_.removeCardFromField(player + 1, slot);
-        players_[player].addCardToGraveyard(card);
-        std::cout << getInfoWithId("I_TEMPORARY") << std::endl;
-      }
+      const char *trait = std::char_traits<char>::find(TRAIT_LETTERS + 1, sizeof(TRAIT_LETTERS) - 2, letter);
+      if (trait == nullptr)
+        return nullptr;
+      traits |= traitBit(static_cast<Trait>(trait - TRAIT_LETTERS));
     }
-  }
+    creature->setCurrentAttack(attack);
+    creature->setCurrentHealth(health);
+    creature->setTraitMask(traits);
+    token.remove_prefix(values_end + 1);
+  }
+
+  int placed_in_round = 0;
+  if (on_board != (!token.empty() && token.front() == '@'))
+    return nullptr;
+  if (on_board && !parseNotationNumber(token.substr(1), placed_in_round))
+    return nullptr;
+  creature->setRoundPlacement(placed_in_round);
+  return card;
 }
 
 //-----------------------------------------------------------------------------------------------------
 ///
-/// Removes creatures from the battle and places them back on the field if possible
+/// Replaces the state of the game with a position in the notation of toNotation. The game is only
+/// changed if the whole notation is valid.
 ///
-/// @return nothing
-void Game::offsetCreaturesOnBoard()
+/// @param notation position notation
+///
+/// @return true = position loaded, false = invalid notation
+bool Game::loadNotation(const std::string &notation)
 {
-  std::shared_ptr<Creature> card = nullptr;
-  for (int player = 0; player < 2; player++)
-  {
-    for (int slot = 0; slot < 7; slot++)
+  std::vector<std::string_view> fields = splitNotation(notation, ' ');
+  if (fields.size() != 14 || fields[1].size() != 2)
+    return false;
+
+  std::vector<std::string_view> rounds = splitNotation(fields[0], '/');
+  int round = 0;
+  int max_rounds = 0;
+  int attacker = fields[1][0] - '0';
+  int active_player = fields[1][1] - '0';
+  if (rounds.size() != 2 || !parseNotationNumber(rounds[0], round) || !parseNotationNumber(rounds[1], max_rounds) ||
+      (attacker != 1 && attacker != 2) || (active_player != 1 && active_player != 2))
+    return false;
+
+  std::vector<Player> players;
+  Board board;
+  for (int number = 1; number <= 2; number++)
+  {
+    const std::string_view *player_fields = &fields[2 + (number - 1) * 6];
+    std::vector<std::string_view> values = splitNotation(player_fields[0], '/');
+    int health = 0;
+    int mana = 0;
+    int mana_pool = 0;
+    if (values.size() != 4 || !parseNotationNumber(values[0], health) || !parseNotationNumber(values[1], mana) ||
+        !parseNotationNumber(values[2], mana_pool) || (values[3] != "r" && values[3] != "-"))
+      return false;
+    Player player(number, mana, health, mana_pool);
+    if (values[3] == "-")
+      player.setRedrawToFalse();
+
+    for (int list = 0; list < 3; list++)
     {
-      card = board_.fetchBattleCard(player + 1, slot);
-      if (card == nullptr)
+      if (player_fields[1 + list] == "-")
         continue;
-      if (!board_.areAllFieldsFull(player + 1))
-        board_.placeCard(card, player, -1);
-      else
-        players_[player].addCardToGraveyard(card);
-      board_.removeCardFromBattle(player + 1, slot);
+      std::vector<std::shared_ptr<Creature>> graveyard;
+      for (std::string_view token : splitNotation(player_fields[1 + list], ','))
+      {
+        std::shared_ptr<Card> card = parseNotationCard(token, false);
+        if (card == nullptr)
+          return false;
+        if (list == 0)
+          player.addCardToHand(card);
+        else if (list == 1)
+          player.addCardToDeck(card);
+        else if (std::dynamic_pointer_cast<Creature>(card) != nullptr)
+          graveyard.push_back(std::dynamic_pointer_cast<Creature>(card));
+        else
+          return false;
+      }
+      // cards are added to the top of the graveyard
+      for (auto creature = graveyard.rbegin(); creature != graveyard.rend(); ++creature)
+        player.addCardToGraveyard(*creature);
     }
-  }
-}
+    players.push_back(player);
 
-Player &Game::getAttacker()
-{
-  return players_[attacker_ - 1];
-}
+    // the battle zone comes first, placing a creature there clears the field slot of the same number
+    for (int zone = 0; zone < 2; zone++)
+    {
+      int slot = 0;
+      for (std::string_view token : splitNotation(player_fields[4 + zone], ','))
+      {
+        int empty_slots = 0;
+        if (parseNotationNumber(token, empty_slots))
+        {
+          if (empty_slots < 1)
+            return false;
+          slot += empty_slots;
+          continue;
+        }
+        std::shared_ptr<Creature> creature = std::dynamic_pointer_cast<Creature>(parseNotationCard(token, true));
+        if (creature == nullptr || slot >= 7)
+          return false;
+        if (zone == 0)
+          board.placeCardInBattle(creature, number, slot, slot);
+        else
+          board.placeCard(creature, number, slot);
+        slot++;
+      }
+      if (slot != 7)
+        return false;
+    }
+  }
 
-Player &Game::getDefender()
-{
-  return players_[defender_ - 1];
+  replaceState(players, board, round, max_rounds, attacker, active_player);
+  return true;
 }
 
 //-----------------------------------------------------------------------------------------------------
@@ -432,13 +1717,25 @@ void Game::processCommand(Player& player, Command command)
   {
     spellWrapper(player, players_[player.getPlayerNumber() == 1 ? 1 : 0], command.getParameters());
   }
+  else if (command.getType() == CommandType::SOLVE)
+  {
+    solveWrapper();
+  }
+  else if (command.getType() == CommandType::SAVE)
+  {
+    saveWrapper();
+  }
+  else if (command.getType() == CommandType::POSITION)
+  {
+    *out_ << toNotation() << std::endl;
+  }
   else if (command.getType() == CommandType::WRONG_PARAM)
   {
-    std::cout << getErrorWithId("E_INVALID_PARAM_COUNT") << std::endl;
+    *out_ << getErrorWithId("E_INVALID_PARAM_COUNT") << std::endl;
   }
   else
   {
-    std::cout << getErrorWithId("E_UNKNOWN_COMMAND") << std::endl;
+    *out_ << getErrorWithId("E_UNKNOWN_COMMAND") << std::endl;
   }
 }
 
@@ -449,7 +1746,7 @@ void Game::processCommand(Player& player, Command command)
 /// @return nothing
 void Game::helpWrapper()
 {
-  std::cout << HELP_TEXT << std::endl;
+  *out_ << HELP_TEXT << std::endl;
   return;
 }
 
@@ -462,16 +1759,16 @@ void Game::helpWrapper()
 /// @return nothing
 void Game::graveyardWrapper(Player& player)
 {
-  std::cout << getDescWithId("D_BORDER_GRAVEYARD") << std::endl;
+  *out_ << getDescWithId("D_BORDER_GRAVEYARD") << std::endl;
   const auto &graveyard = player.getGraveyard();
   if (!graveyard.empty())
   {
     for (const auto &it : player.getGraveyard())
     {
-      std::cout << it->getCardID() << " | " << it->getCardName() << std::endl;
+      *out_ << it->getCardID() << " | " << it->getCardName() << std::endl;
     }
   }
-  std::cout << getDescWithId("D_BORDER_D") << std::endl;
+  *out_ << getDescWithId("D_BORDER_D") << std::endl;
 }
 
 //-----------------------------------------------------------------------------------------------------
@@ -484,7 +1781,7 @@ void Game::boardWrapper()
   board_.toggleActive();
   if (board_.isActive())
   {
-    board_.printBoard(defender_, getDescWithId("D_BORDER_A"), getDescWithId("D_BORDER_B"));
+    board_.printBoard(defender_, getDescWithId("D_BORDER_A"), getDescWithId("D_BORDER_B"), *out_);
   }
 }
 
@@ -497,9 +1794,9 @@ void Game::boardWrapper()
 /// @return nothing
 void Game::handWrapper(Player& player)
 {
-  std::cout << getDescWithId("D_BORDER_HAND") << std::endl;
-  players_[player.getPlayerNumber() - 1].printHand();
-  std::cout << getDescWithId("D_BORDER_D") << std::endl;
+  *out_ << getDescWithId("D_BORDER_HAND") << std::endl;
+  players_[player.getPlayerNumber() - 1].printHand(*out_);
+  *out_ << getDescWithId("D_BORDER_D") << std::endl;
 }
 
 //-----------------------------------------------------------------------------------------------------
@@ -533,11 +1830,11 @@ void Game::infoWrapper(std::vector<std::string>& parameters)
 
   if (!doesCardExist(card_id))
   {
-    std::cout << getErrorWithId("E_INVALID_CARD") << std::endl;
+    *out_ << getErrorWithId("E_INVALID_CARD") << std::endl;
     return;
   }
 
-  for (auto &it : creature_codebook_)
+  for (auto &it : *creature_codebook_)
   {
     if (it->getCardID() == card_id)
     {
@@ -547,7 +1844,7 @@ void Game::infoWrapper(std::vector<std::string>& parameters)
   }
   if (!card)
   {
-    for (const auto &it : spell_codebook_)
+    for (const auto &it : *spell_codebook_)
     {
       if (it->getCardID() == card_id)
       {
@@ -557,7 +1854,7 @@ void Game::infoWrapper(std::vector<std::string>& parameters)
     }
   }
 
-  card->printInfo(getDescWithId("D_BORDER_INFO"), getDescWithId("D_BORDER_D"));
+  card->printInfo(getDescWithId("D_BORDER_INFO"), getDescWithId("D_BORDER_D"), *out_);
 }
 
 //-----------------------------------------------------------------------------------------------------
@@ -571,7 +1868,7 @@ void Game::redrawWrapper(Player& player)
 {
   if (!player.getRedrawStatus())
   {
-    std::cout << getErrorWithId("E_REDRAW_DISABLED") << std::endl;
+    *out_ << getErrorWithId("E_REDRAW_DISABLED") << std::endl;
     return;
   }
 
@@ -579,7 +1876,7 @@ void Game::redrawWrapper(Player& player)
 
   if (hand_size < 2)
   {
-    std::cout << getErrorWithId("E_REDRAW_NOT_ENOUGH_CARDS") << std::endl;
+    *out_ << getErrorWithId("E_REDRAW_NOT_ENOUGH_CARDS") << std::endl;
     return;
   }
 
@@ -630,15 +1927,87 @@ std::string Game::printRole(int player) const
 /// @return nothing
 void Game::statusWrapper()
 {
-  std::cout << getDescWithId("D_BORDER_STATUS") << std::endl;
-  std::cout << "Player 1" << std::endl;
-  std::cout << printRole(1) << std::endl;
-  std::cout << players_[0]; // Use the overloaded operator
-  std::cout << getDescWithId("D_BORDER_C") << std::endl;
-  std::cout << "Player 2" << std::endl;
-  std::cout << printRole(2) << std::endl;
-  std::cout << players_[1]; // Use the overloaded operator
-  std::cout << getDescWithId("D_BORDER_D") << std::endl;
+  *out_ << getDescWithId("D_BORDER_STATUS") << std::endl;
+  *out_ << "Player 1" << std::endl;
+  *out_ << printRole(1) << std::endl;
+  *out_ << players_[0]; // Use the overloaded operator
+  *out_ << getDescWithId("D_BORDER_C") << std::endl;
+  *out_ << "Player 2" << std::endl;
+  *out_ << printRole(2) << std::endl;
+  *out_ << players_[1]; // Use the overloaded operator
+  *out_ << getDescWithId("D_BORDER_D") << std::endl;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Processes the logic for the Command::SOLVE. Searches the current position to the end of the game
+/// and prints the outcome under perfect play of both players. Solved positions are kept in a table on
+/// disk, so later searches can reuse them.
+///
+/// @return nothing
+void Game::solveWrapper()
+{
+  if (!solve_table_)
+  {
+    try
+    {
+      solve_table_ = std::make_shared<SolveTable>(SOLVE_TABLE_FILE);
+    }
+    catch (const file_error &e)
+    {
+      *out_ << e.what() << std::endl;
+    }
+  }
+
+  Solver solver(solve_table_.get(), SOLVER_NODE_LIMIT);
+  SolverResult result = solver.solve(*this);
+
+  *out_ << "=== Solver ==============================================================================" << std::endl;
+  switch (result.outcome)
+  {
+  case Outcome::PLAYER1_WINS:
+    *out_ << "Outcome: Player 1 wins" << std::endl;
+    break;
+  case Outcome::PLAYER2_WINS:
+    *out_ << "Outcome: Player 2 wins" << std::endl;
+    break;
+  case Outcome::DRAW:
+    *out_ << "Outcome: Tie" << std::endl;
+    break;
+  case Outcome::UNKNOWN:
+    *out_ << "Outcome: Unknown (search limit reached)" << std::endl;
+    break;
+  }
+  if (result.outcome != Outcome::UNKNOWN)
+  {
+    *out_ << "Best action: " << result.best_action.toString() << std::endl;
+  }
+  *out_ << "Searched positions: " << result.nodes << " (" << result.table_hits << " from table)" << std::endl;
+  *out_ << getDescWithId("D_BORDER_D") << std::endl;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Processes the logic for the Command::SAVE. Writes the saved game to the save file, the game can be
+/// resumed from there with the --resume option. The file is written under a temporary name and renamed,
+/// so games of the server that save at the same time never leave a mixed file.
+///
+/// @return nothing
+void Game::saveWrapper()
+{
+  std::vector<uint8_t> state = saveState();
+  std::string temporary_name = std::string(SAVED_GAME_FILE) + "." + std::to_string(getpid()) + "." +
+                               std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+  std::ofstream file(temporary_name, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char *>(state.data()), state.size());
+  file.close();
+  if (!file || std::rename(temporary_name.c_str(), SAVED_GAME_FILE) != 0)
+  {
+    std::remove(temporary_name.c_str());
+    *out_ << file_error(SAVED_GAME_FILE).what() << std::endl;
+    return;
+  }
+  *out_ << "Game saved to " << SAVED_GAME_FILE << " (" << state.size() << " bytes)." << std::endl;
 }
 
 //-----------------------------------------------------------------------------------------------------
@@ -656,19 +2025,19 @@ void Game::battleWrapper(Player& player, std::vector<std::string>& parameters)
 
   if (!isValidFieldSlot(fieldSlot) || !isValidFieldSlot(battleSlot))
   {
-    std::cout << getErrorWithId("E_INVALID_SLOT") << std::endl;
+    *out_ << getErrorWithId("E_INVALID_SLOT") << std::endl;
     return;
   }
 
   if (!checkFieldSlot(fieldSlot))
   {
-    std::cout << getErrorWithId("E_NOT_IN_FIELD") << std::endl;
+    *out_ << getErrorWithId("E_NOT_IN_FIELD") << std::endl;
     return;
   }
 
-  if (!board_.isFieldSlotOccupied(player.getPlayerNumber() - 1, fieldSlot[1] - '0' - 1))
+  if (!board_.isFieldSlotOccupied(player.getPlayerNumber(), fieldSlot[1] - '0' - 1))
   {
-    std::cout << getErrorWithId("E_FIELD_EMPTY") << std::endl;
+    *out_ << getErrorWithId("E_FIELD_EMPTY") << std::endl;
     return;
   }
 
@@ -676,40 +2045,36 @@ void Game::battleWrapper(Player& player, std::vector<std::string>& parameters)
   int battle_pos = battleSlot[1] - '0';
   --field_pos;
   --battle_pos;
-  std::shared_ptr<Creature> current_card = board_.fetchFieldCard(player.getPlayerNumber(), field_pos);
+  const Creature *current_card = board_.fetchFieldCard(player.getPlayerNumber(), field_pos);
 
-  bool has_haste = false;
-  if (isCreatureTraitHaste(current_card) && (current_card->getRoundPlacement() == round_))
-  {
-    has_haste = true;
-  }
-  else if (!isCreatureTraitHaste(current_card) && (current_card->getRoundPlacement() == round_))
+  if (!isCreatureTraitHaste(current_card) && (current_card->getRoundPlacement() == round_))
   {
-    std::cout << getErrorWithId("E_CREATURE_CANNOT_BATTLE") << std::endl;
+    *out_ << getErrorWithId("E_CREATURE_CANNOT_BATTLE") << std::endl;
     return;
   }
 
   if (!checkBattleSlot(battleSlot))
   {
-    std::cout << getErrorWithId("E_NOT_IN_BATTLE") << std::endl;
+    *out_ << getErrorWithId("E_NOT_IN_BATTLE") << std::endl;
     return;
   }
-  if (board_.isBattleSlotOccupied(player.getPlayerNumber() - 1, battleSlot[1] - '0' - 1))
+  if (board_.isBattleSlotOccupied(player.getPlayerNumber(), battleSlot[1] - '0' - 1))
   {
-    std::cout << getErrorWithId("E_BATTLE_OCCUPIED") << std::endl;
+    *out_ << getErrorWithId("E_BATTLE_OCCUPIED") << std::endl;
     return;
   }
 
-  board_.placeCardInBattle(current_card, player.getPlayerNumber(), battle_pos, field_pos);
-  if (has_haste)
-  {
-    std::cout << getInfoWithId("I_HASTE") << std::endl;
-  }
+  board_.moveCardToBattle(player.getPlayerNumber(), field_pos, battle_pos);
 
-  if (isCreatureTraitChallenger(current_card))
+  const TraitRegistry &traits = TraitRegistry::get();
+  if (current_card->getTraitMask() & traits.getMask(TraitPhase::ENTER_BATTLE))
   {
-    int opponent = (player.getPlayerNumber() - 1) == 0 ? 1 : 0;
-    challengeTheOpponent(opponent, battle_pos);
+    TraitEvent event;
+    event.creature = board_.fetchBattleCard(player.getPlayerNumber(), battle_pos);
+    event.player = player.getPlayerNumber();
+    event.slot = battle_pos;
+    event.battle = true;
+    traits.dispatch(*this, TraitPhase::ENTER_BATTLE, &event, 1);
   }
   player.setRedrawToFalse();
 }
@@ -751,48 +2116,41 @@ bool Game::checkBattleSlot(std::string battleSlot)
 /// @param card card
 ///
 /// @return true = has Haste, false = does not have Haste
-bool Game::isCreatureTraitHaste(std::shared_ptr<Creature> card)
+bool Game::isCreatureTraitHaste(const Creature *card)
 {
-  std::vector<Trait> traits = card->getTraits();
-
-  for (const auto &trait : traits)
-  {
-    if (trait == Trait::H)
-    {
-      return true;
-    }
-  }
-
-  return false;
+  return card->checkTrait(Trait::H);
 }
 
 //-----------------------------------------------------------------------------------------------------
 ///
-/// Checks if the creature has Trait::C
+/// Trait::H: tells that the creature battles in the round it was placed
 ///
-/// @param card card
+/// @param event creature and its battle slot
 ///
-/// @return true = has Challenger, false = does not have Challenger
-bool Game::isCreatureTraitChallenger(std::shared_ptr<Creature> card)
+/// @return nothing
+void Game::hasteHook(TraitEvent &event)
 {
-  std::vector<Trait> traits = card->getTraits();
-
-  for (const auto &trait : traits)
-  {
-    if (trait == Trait::C)
-    {
-      return true;
-    }
-  }
+  if (event.creature->getRoundPlacement() == round_)
+    *out_ << getInfoWithId("I_HASTE") << std::endl;
+}
 
-  return false;
+//-----------------------------------------------------------------------------------------------------
+///
+/// Trait::C: the opposite creature of the opponent has to battle too
+///
+/// @param event creature and its battle slot
+///
+/// @return nothing
+void Game::challengerHook(TraitEvent &event)
+{
+  challengeTheOpponent(3 - event.player, event.slot);
 }
 
 //-----------------------------------------------------------------------------------------------------
 ///
 /// Processes the logic for the Challenger trait
 ///
-/// @param opponent opponent
+/// @param opponent player number of the opponent
 /// @param battle_pos battle position
 ///
 /// @return nothing
@@ -800,10 +2158,8 @@ void Game::challengeTheOpponent(int opponent, int battle_pos)
 {
   if (checkOpponentsField(battle_pos, opponent) && !checkOpponentsBattleField(battle_pos, opponent))
   {
-    std::shared_ptr<Creature> current_card = board_.fetchFieldCard(opponent + 1, battle_pos);
-
-    board_.placeCardInBattle(current_card, opponent + 1, battle_pos, battle_pos);
-    std::cout << getInfoWithId("I_CHALLENGER") << std::endl;
+    board_.moveCardToBattle(opponent, battle_pos, battle_pos);
+    *out_ << getInfoWithId("I_CHALLENGER") << std::endl;
   }
 }
 
@@ -812,7 +2168,7 @@ void Game::challengeTheOpponent(int opponent, int battle_pos)
 /// Checks if the opponent has a creature in the field zone
 ///
 /// @param battle_pos battle position
-/// @param opponent opponent
+/// @param opponent player number of the opponent
 ///
 /// @return true = has a creature, false = does not have a creature
 bool Game::checkOpponentsField(int battle_pos, int opponent)
@@ -830,7 +2186,7 @@ bool Game::checkOpponentsField(int battle_pos, int opponent)
 /// Checks if the opponent has a creature in the battle zone
 ///
 /// @param battle_pos battle position
-/// @param opponent opponent
+/// @param opponent player number of the opponent
 ///
 /// @return true = has a creature, false = does not have a creature
 bool Game::checkOpponentsBattleField(int battle_pos, int opponent)
@@ -851,7 +2207,7 @@ bool Game::checkOpponentsBattleField(int battle_pos, int opponent)
 /// @return true = valid, false = invalid
 bool Game::isValidFieldSlot(std::string slotString)
 {
-  std::regex r("[oO]?([fF]|[bB])[1-7]");
+  static const std::regex r("[oO]?([fF]|[bB])[1-7]");
   return regex_match(slotString, r);
 }
 
@@ -864,7 +2220,7 @@ bool Game::isValidFieldSlot(std::string slotString)
 /// @return true = exists, false = does not exist
 bool Game::doesCardExist(std::string card_id)
 {
-  for (const auto &it : creature_codebook_)
+  for (const auto &it : *creature_codebook_)
   {
     if (it->getCardID() == card_id)
     {
@@ -872,7 +2228,7 @@ bool Game::doesCardExist(std::string card_id)
     }
   }
 
-  for (const auto &it : spell_codebook_)
+  for (const auto &it : *spell_codebook_)
   {
     if (it->getCardID() == card_id)
     {
@@ -930,7 +2286,7 @@ std::shared_ptr<Card> Game::getFromHand(std::string card_id, Player& player)
 /// @return true = is a creature, false = is not a creature
 bool Game::cardIsCreature(std::string card_id)
 {
-  for (const auto &it : creature_codebook_)
+  for (const auto &it : *creature_codebook_)
   {
     if (it->getCardID() == card_id)
     {
@@ -949,7 +2305,7 @@ bool Game::cardIsCreature(std::string card_id)
 /// @return true = is a spell, false = is not a spell
 bool Game::cardIsSpell(std::string card_id)
 {
-  for (const auto &it : spell_codebook_)
+  for (const auto &it : *spell_codebook_)
   {
     if (it->getCardID() == card_id)
     {
@@ -993,48 +2349,48 @@ void Game::creatureWrapper(Player& player, std::vector<std::string>& parameters)
 
   if (!doesCardExist(card_id_uppercase))
   {
-    std::cout << getErrorWithId("E_INVALID_CARD") << std::endl;
+    *out_ << getErrorWithId("E_INVALID_CARD") << std::endl;
     return;
   }
   else if (!isValidFieldSlot(fieldSlot))
   {
-    std::cout << getErrorWithId("E_INVALID_SLOT") << std::endl;
+    *out_ << getErrorWithId("E_INVALID_SLOT") << std::endl;
     return;
   }
   else if (!isInHand(player, card_id_uppercase))
   {
-    std::cout << getErrorWithId("E_NOT_IN_HAND") << std::endl;
+    *out_ << getErrorWithId("E_NOT_IN_HAND") << std::endl;
     return;
   }
   else if (!cardIsCreature(card_id_uppercase))
   {
-    std::cout << getErrorWithId("E_NOT_CREATURE") << std::endl;
+    *out_ << getErrorWithId("E_NOT_CREATURE") << std::endl;
     return;
   }
   else if (!checkFieldSlot(fieldSlot))
   {
-    std::cout << getErrorWithId("E_NOT_IN_FIELD") << std::endl;
+    *out_ << getErrorWithId("E_NOT_IN_FIELD") << std::endl;
     return;
   }
   else if (board_.fetchFieldCard(player.getPlayerNumber(), field_position - 1) != nullptr)
   {
-    std::cout << getErrorWithId("E_FIELD_OCCUPIED") << std::endl;
+    *out_ << getErrorWithId("E_FIELD_OCCUPIED") << std::endl;
     return;
   }
 
   std::shared_ptr<Creature> card_from_hand = std::dynamic_pointer_cast<Creature>(getFromHand(card_id_uppercase, player));
   if (!isEnoughMana(player, card_from_hand->getManaCost()))
   {
-    std::cout << getErrorWithId("E_NOT_ENOUGH_MANA") << std::endl;
+    *out_ << getErrorWithId("E_NOT_ENOUGH_MANA") << std::endl;
     return;
   }
 
   int playerID = player.getPlayerNumber();
-  board_.placeCard(card_from_hand, playerID - 1, field_position - 1);
+  board_.placeCard(card_from_hand, playerID, field_position - 1);
   player.subtractMana(card_from_hand->getManaCost());
   card_from_hand->setRoundPlacement(round_);
   std::string card_ID = "I_" + card_id_uppercase;
-  std::cout << getInfoWithId(card_ID) << std::endl;
+  *out_ << getInfoWithId(card_ID) << std::endl;
   player.removeFromHand(card_id_uppercase);
   player.setRedrawToFalse();
 }
@@ -1044,7 +2400,7 @@ void Game::creatureWrapper(Player& player, std::vector<std::string>& parameters)
 /// Processes the logic for the Command::SPELL
 ///
 /// @param player player
-/// @param opponent opponent
+/// @param opponent player number of the opponent
 /// @param parameters parameters
 ///
 /// @return nothing
@@ -1052,7 +2408,7 @@ void Game::spellWrapper(Player& player, Player& opponent, std::vector<std::strin
 {
   if (parameters.empty())
   {
-    std::cout << getErrorWithId("E_MISSING_CARD") << std::endl;
+    *out_ << getErrorWithId("E_MISSING_CARD") << std::endl;
     return;
   }
 
@@ -1061,45 +2417,35 @@ void Game::spellWrapper(Player& player, Player& opponent, std::vector<std::strin
 
   if (!doesCardExist(card_id))
   {
-    std::cout << getErrorWithId("E_INVALID_CARD") << std::endl;
+    *out_ << getErrorWithId("E_INVALID_CARD") << std::endl;
     return;
   }
   std::shared_ptr<Card> testing_card_from_hand = getFromHand(card_id, player);
   if (testing_card_from_hand == nullptr)
   {
-    std::cout << getErrorWithId("E_NOT_IN_HAND") << std::endl;
+    *out_ << getErrorWithId("E_NOT_IN_HAND") << std::endl;
     return;
   }
   std::shared_ptr<Spell> card_from_hand = std::dynamic_pointer_cast<Spell>(testing_card_from_hand);
   if (!cardIsSpell(card_id))
   {
-    std::cout << getErrorWithId("E_NOT_SPELL") << std::endl;
-    return;
-  }
-  int spell_type = card_from_hand->getSpellCardType(card_id);
-  if (spell_type == 1 && parameters.size() != 1)
-  {
-    std::cout << getErrorWithId("E_INVALID_PARAM_COUNT_SPELL") << std::endl;
-    return;
-  }
-  else if (spell_type == 2 && parameters.size() != 2)
-  {
-    std::cout << getErrorWithId("E_INVALID_PARAM_COUNT_SPELL") << std::endl;
+    *out_ << getErrorWithId("E_NOT_SPELL") << std::endl;
     return;
   }
-  else if (spell_type == 3 && parameters.size() != 2)
+  SpellTarget spell_target = card_from_hand->getTarget();
+  if (parameters.size() != (spell_target == SpellTarget::NONE ? 1u : 2u))
   {
-    std::cout << getErrorWithId("E_INVALID_PARAM_COUNT_SPELL") << std::endl;
+    *out_ << getErrorWithId("E_INVALID_PARAM_COUNT_SPELL") << std::endl;
     return;
   }
   std::shared_ptr<Creature> affected_creature = nullptr;
   bool on_opponent_side = false;
-  if (spell_type == 2)
+  if (spell_target == SpellTarget::CREATURE)
   {
     std::string slot_str = parameters[1];
     if (!isValidFieldSlot(slot_str))
     {
-      std::cout << getErrorWithId("E_INVALID_SLOT_SPELL") << std::endl;
+      *out_ << getErrorWithId("E_INVALID_SLOT_SPELL") << std::endl;
       return;
     }
 
@@ -1120,71 +2466,55 @@ void Game::spellWrapper(Player& player, Player& opponent, std::vector<std::strin
     {
       if (on_opponent_side)
       {
-        affected_creature = board_.fetchFieldCard(opponent.getPlayerNumber(), slot_number);
+        affected_creature = board_.shareFieldCard(opponent.getPlayerNumber(), slot_number);
       }
       else
       {
-        affected_creature = board_.fetchFieldCard(player.getPlayerNumber(), slot_number);
+        affected_creature = board_.shareFieldCard(player.getPlayerNumber(), slot_number);
       }
     }
     else if (slot_char == 'b' || slot_char == 'B')
     {
       if (on_opponent_side)
       {
-        affected_creature = board_.fetchBattleCard(opponent.getPlayerNumber(), slot_number);
+        affected_creature = board_.shareBattleCard(opponent.getPlayerNumber(), slot_number);
       }
       else
       {
-        affected_creature = board_.fetchBattleCard(player.getPlayerNumber(), slot_number);
+        affected_creature = board_.shareBattleCard(player.getPlayerNumber(), slot_number);
       }
     }
 
     if (affected_creature == nullptr)
     {
-      std::cout << getErrorWithId("E_TARGET_EMPTY") << std::endl;
+      *out_ << getErrorWithId("E_TARGET_EMPTY") << std::endl;
       return;
     }
   }
-  else if (spell_type == 3)
+  else if (spell_target == SpellTarget::GRAVEYARD)
   {
     std::string card_id = stringToUpper(parameters[1]);
     affected_creature = player.getFromGraveyard(card_id);
     if (!affected_creature)
     {
-      std::cout << getErrorWithId("E_NOT_IN_GRAVEYARD") << std::endl;
+      *out_ << getErrorWithId("E_NOT_IN_GRAVEYARD") << std::endl;
       return;
     }
   }
-  int mana_cost = 0;
-  if (!card_from_hand->hasMana())
-  {
-    if (card_id == "CLONE" || card_id == "MEMRY")
-    {
-      mana_cost = (affected_creature->getManaCost() + 1) / 2;
-    }
-    else if (card_id == "CURSE")
-    {
-      mana_cost = affected_creature->getManaCost() + 1;
-    }
-  }
-  else
-  {
-    mana_cost = card_from_hand->getManaCost();
-  }
-
-  if (mana_cost > player.getMana())
+  int required_mana = card_from_hand->getRequiredMana();
+  if (required_mana > player.getMana())
   {
-    std::cout << getErrorWithId("E_NOT_ENOUGH_MANA") << std::endl;
+    *out_ << getErrorWithId("E_NOT_ENOUGH_MANA") << std::endl;
     return;
   }
 
-  card_from_hand->processSpell(card_id, player, opponent, board_, affected_creature, round_);
+  int mana_cost = card_from_hand->getManaCost(affected_creature.get());
+  std::string target_id = affected_creature ? affected_creature->getCardID() : "";
+  card_from_hand->cast(player, opponent, board_, affected_creature, round_, arena_);
+  logEvent(EventType::SPELL, player.getPlayerNumber(), -1, card_id, target_id, required_mana);
   checkCreatureDeaths();
-  std::cout << getInfoWithId("I_" + card_id) << std::endl;
-  if (card_from_hand->hasMana())
-  {
-    player.subtractMana(card_from_hand->getManaCost());
-  }
+  *out_ << getInfoWithId("I_" + card_id) << std::endl;
+  player.subtractMana(mana_cost);
   player.removeFromHand(card_id);
   player.setRedrawToFalse();
 }
@@ -1198,7 +2528,8 @@ void Game::spellWrapper(Player& player, Player& opponent, std::vector<std::strin
 /// @return description message
 std::string Game::getDescWithId(const std::string id) const
 {
-  auto it = descriptions_.find(id);
+  AllocationScope scope(AllocationSubsystem::MESSAGES);
+  auto it = descriptions_->find(id);
   return it->second;
 }
 
@@ -1211,7 +2542,8 @@ std::string Game::getDescWithId(const std::string id) const
 /// @return error message
 std::string Game::getErrorWithId(const std::string id) const
 {
-  auto it = errors_.find(id);
+  AllocationScope scope(AllocationSubsystem::MESSAGES);
+  auto it = errors_->find(id);
   return "[ERROR] " + it->second;
 }
 
@@ -1224,64 +2556,93 @@ std::string Game::getErrorWithId(const std::string id) const
 /// @return info message
 std::string Game::getInfoWithId(const std::string& id) const
 {
-  auto it = infos_.find(id);
+  AllocationScope scope(AllocationSubsystem::MESSAGES);
+  auto it = infos_->find(id);
   return "[INFO] " + it->second;
 }
 
 //-----------------------------------------------------------------------------------------------------
 ///
-/// Checks if the creatures are dead and moves them to the graveyard
+/// Moves the dead creatures to the graveyard. Only the slots the board marked as dying are looked at,
+/// battle zones before field zones and player 1 before player 2.
 ///
 /// @return nothing
 void Game::checkCreatureDeaths()
 {
-  std::shared_ptr<Creature> card = nullptr;
-
-  for (int player = 0; player < 2; player++)
-  {
-    for (int slot = 0; slot < 7; slot++)
-    {
-      card = board_.fetchBattleCard(player + 1, slot);
-      if (card != nullptr)
-      {
-        if (card->isDead())
-        {
-          players_[player].addCardToGraveyard(card);
-          board_.removeCardFromBattle(player + 1, slot);
-        }
-      }
-    }
+  uint32_t dying = board_.takeDyingLocations();
+  while (dying)
+  {
+    int location = std::countr_zero(dying);
+    dying &= dying - 1;
+    bool battle = location < BOARD_FIELD_LOCATION;
+    int player = location % BOARD_FIELD_LOCATION / BOARD_SLOTS;
+    int slot = location % BOARD_SLOTS;
+    Creature *card = battle ? board_.fetchBattleCard(player + 1, slot) : board_.fetchFieldCard(player + 1, slot);
+    if (card == nullptr || !card->isDead())
+      continue;
+    logEvent(EventType::DEATH, player + 1, slot, card->getCardID());
+    players_[player].addCardToGraveyard(battle ? board_.takeBattleCard(player + 1, slot)
+                                               : board_.takeFieldCard(player + 1, slot));
   }
-  for (int player = 0; player < 2; player++)
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Runs the UPKEEP hooks on the creatures of the player, e.g. Trait::R and Trait::P
+///
+/// @param player player
+///
+/// @return nothing
+void Game::applyTraits(int player)
+{
+  const TraitRegistry &traits = TraitRegistry::get();
+  uint16_t mask = traits.getMask(TraitPhase::UPKEEP);
+  TraitEvent events[TRAIT_BOARD_EVENT_LIMIT];
+  int count = 0;
+  for (int slot = 0; slot < 7; slot++)
   {
-    for (int slot = 0; slot < 7; slot++)
+    for (int battle = 0; battle <= 1; battle++)
     {
-      card = board_.fetchFieldCard(player + 1, slot);
-      if (card != nullptr)
-      {
-        if (card->isDead())
-        {
-          players_[player].addCardToGraveyard(card);
-          board_.removeCardFromField(player + 1, slot);
-        }
-      }
+      Creature *card = battle ? board_.fetchBattleCard(player, slot) : board_.fetchFieldCard(player, slot);
+      if (card == nullptr || !(card->getTraitMask() & mask))
+        continue;
+      events[count].creature = card;
+      events[count].player = player;
+      events[count].slot = slot;
+      events[count].battle = battle;
+      count++;
     }
   }
+  traits.dispatch(*this, TraitPhase::UPKEEP, events, count);
+  checkCreatureDeaths();
 }
 
 //-----------------------------------------------------------------------------------------------------
 ///
-/// Applies the effects of the Trait::R and Trait::P
+/// Trait::R: the creature regains its base health in every odd round
 ///
-/// @param player player
+/// @param event creature
 ///
 /// @return nothing
-void Game::applyTraits(int player)
+void Game::regenerateHook(TraitEvent &event)
 {
-  if (round_ % 2 == 1)
+  if (round_ % 2 == 1 && event.creature->resetHealth())
   {
-    board_.regenerateCreatures(player, getInfoWithId("I_REGENERATE"));
+    *out_ << getInfoWithId("I_REGENERATE") << std::endl;
+    logEvent(EventType::TRAIT, event.player, -1, event.creature->getCardID(), "", 0, 'R');
   }
-  board_.damagePoisonedCreatures(player, getInfoWithId("I_POISONED"));
-  checkCreatureDeaths();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Trait::P: the creature takes 1 damage
+///
+/// @param event creature
+///
+/// @return nothing
+void Game::poisonedHook(TraitEvent &event)
+{
+  board_.damageCreature(event.creature, 1);
+  *out_ << getInfoWithId("I_POISONED") << std::endl;
+  logEvent(EventType::TRAIT, event.player, -1, event.creature->getCardID(), "", 1, 'P');
 }
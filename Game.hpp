@@ -3,8 +3,12 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <regex>
+#include <memory>
+#include <cstdint>
+#include <random>
 
 #include "Command.hpp"
 #include "CommandLine.hpp"
@@ -15,6 +19,10 @@
 #include "Creature.hpp"
 #include "Spell.hpp"
 #include "Exeption.hpp"
+#include "EventLog.hpp"
+#include "AllocationTracker.hpp"
+#include "StateBuffer.hpp"
+#include "TraitHooks.hpp"
 
 #define HELP_TEXT "=== Commands ============================================================================\n" \
                   "- help\n"                                                                                    \
@@ -58,26 +66,57 @@
                   "    <TARGET_SLOT>: The slot to target with a target spell\n"                                 \
                   "    <GRAVEYARD_CARD_ID>: The ID of a card in the graveyard to cast a graveyard spell on\n"   \
                   "\n"                                                                                          \
+                  "- solve\n"                                                                                   \
+                  "    Searches the current position and prints its outcome under perfect play.\n"             \
+                  "\n"                                                                                          \
+                  "- position\n"                                                                                \
+                  "    Prints the position in one line, it can be loaded with the --position option.\n"        \
+                  "\n"                                                                                          \
+                  "- save\n"                                                                                    \
+                  "    Saves the game, it can be resumed with the --resume option.\n"                          \
+                  "\n"                                                                                          \
                   "- status\n"                                                                                  \
                   "    Prints general information about both players.\n"                                        \
                   "\n"                                                                                          \
                   "========================================================================================="
 
+class SolveTable;
+struct MatchCounters;
+
 class Game
 {
 protected:
+  std::shared_ptr<CardArena> arena_;
   std::vector<Player> players_;
   int attacker_;
   int defender_;
+  int active_player_;
   int max_rounds_;
   int round_;
   Board board_;
-  const std::map<std::string, std::string> errors_;
-  const std::map<std::string, std::string> infos_;
-  const std::map<std::string, std::string> descriptions_;
-
-  std::vector<std::shared_ptr<Creature>> creature_codebook_;
-  std::vector<std::shared_ptr<Spell>> spell_codebook_;
+  std::shared_ptr<const std::map<std::string, std::string>> errors_;
+  std::shared_ptr<const std::map<std::string, std::string>> infos_;
+  std::shared_ptr<const std::map<std::string, std::string>> descriptions_;
+
+  std::shared_ptr<const std::vector<std::shared_ptr<Creature>>> creature_codebook_;
+  std::shared_ptr<const std::vector<std::shared_ptr<Spell>>> spell_codebook_;
+  std::shared_ptr<SolveTable> solve_table_;
+
+  std::shared_ptr<EventRing> events_;
+  AllocationReport *allocations_;
+  MatchCounters *counters_;
+
+  std::ostream null_out_;
+  std::ostream *out_;
+
+  void logEvent(EventType type, int player, int slot, const std::string &card, const std::string &target = "",
+                int value = 0, char trait = 0);
+  void writeCard(StateWriter &writer, const Card *card, bool on_board) const;
+  uint64_t hashPosition(int observer) const;
+  std::shared_ptr<Card> readCard(StateReader &reader, bool on_board) const;
+  std::shared_ptr<Card> parseNotationCard(std::string_view token, bool on_board) const;
+  void replaceState(const std::vector<Player> &players, Board &board, int round, int max_rounds, int attacker,
+                    int active_player);
 
 public:
   // Forward declarations
@@ -86,23 +125,56 @@ public:
        const std::map<std::string, std::string> &descriptions,
        int max_rounds,
        std::vector<std::shared_ptr<Creature>> creature_codebook,
-       std::vector<std::shared_ptr<Spell>> spell_codebook);
+       std::vector<std::shared_ptr<Spell>> spell_codebook,
+       std::ostream *out = &std::cout, std::shared_ptr<CardArena> arena = nullptr);
+  Game(const Game &other);
+  Game &operator=(const Game &) = delete;
 
   ~Game() = default;
 
+  void setOutputStream(std::ostream *out);
+  void printWelcome();
+  void setEventStream(std::shared_ptr<EventRing> events) { events_ = events; }
+  void setAllocationReport(AllocationReport *allocations) { allocations_ = allocations; }
+  void setMatchCounters(MatchCounters *counters) { counters_ = counters; }
+  void setSolveTable(std::shared_ptr<SolveTable> solve_table) { solve_table_ = solve_table; }
+  const std::shared_ptr<CardArena> &getArena() const { return arena_; }
+
   void endGame(int game_status, std::string config_file_name);
 
   int startRound();
   int battlePhase();
-  void resolvingFight(std::shared_ptr<Creature> attacking_card, std::shared_ptr<Creature> defending_card);
-  void resolveFightTraits(std::shared_ptr<Creature> attacking_card, std::shared_ptr<Creature> defending_card, int defender);
+  void resolvingFight(Creature *attacking_card, Creature *defending_card);
+  void resolveFightGeneric(Creature *attacking_card, Creature *defending_card);
+  void resolveFightTraits(Creature *attacking_card, Creature *defending_card, int defender);
+  template <uint8_t ATTACKER, uint8_t DEFENDER> void resolveFight(Creature *attacking_card, Creature *defending_card);
+  template <uint8_t TRAITS> void strike(Creature *attacking_card, Creature *defending_card, int defender);
+  int checkFightResolvers(std::ostream &report) const;
 
   void handleTemporaryCards();
   void offsetCreaturesOnBoard();
   Player &getAttacker();
   Player &getDefender();
+  Player &getActivePlayer();
   int getAttackerNumber() const { return attacker_; }
   int getDefenderNumber() const { return defender_; }
+  int getActivePlayerNumber() const { return active_player_; }
+  const Player &getPlayer(int player) const { return players_[player - 1]; }
+  const Board &getBoard() const { return board_; }
+  int getRound() const { return round_; }
+  int getMaxRounds() const { return max_rounds_; }
+
+  int finishPhase();
+  int applyAction(Command command);
+  std::vector<Command> generateActions() const;
+  uint64_t positionHash() const;
+  uint64_t visibleHash(int observer) const;
+  std::vector<uint8_t> saveState() const;
+  bool restoreState(const std::vector<uint8_t> &state);
+  std::string toNotation() const;
+  bool loadNotation(const std::string &notation);
+  static int winnerFromStatus(int game_status);
+  void determinize(int observer, std::mt19937_64 &generator);
 
   void processCommand(Player &player, Command command);
   void setRedrawFalse(Player &player);
@@ -118,11 +190,12 @@ public:
   void infoWrapper(std::vector<std::string> &parameters);
   void redrawWrapper(Player &player);
   void statusWrapper();
+  void solveWrapper();
+  void saveWrapper();
   void battleWrapper(Player &player, std::vector<std::string> &parameters);
   bool checkFieldSlot(std::string fieldSlot);
   bool checkBattleSlot(std::string battleSlot);
-  bool isCreatureTraitHaste(std::shared_ptr<Creature> card);
-  bool isCreatureTraitChallenger(std::shared_ptr<Creature> card);
+  bool isCreatureTraitHaste(const Creature *card);
   void challengeTheOpponent(int opponent, int battle_pos);
   bool checkOpponentsField(int battle_pos, int opponent);
   bool checkOpponentsBattleField(int battle_pos, int opponent);
@@ -133,7 +206,7 @@ public:
 
   void printBoard()
   {
-    board_.printBoard(defender_, descriptions_.at("D_BORDER_A"), descriptions_.at("D_BORDER_B"));
+    board_.printBoard(defender_, descriptions_->at("D_BORDER_A"), descriptions_->at("D_BORDER_B"), *out_);
   }
 
   bool isValidFieldSlot(std::string slotString);
@@ -147,6 +220,16 @@ public:
   void applyTraits(int player);
   void handleUndyingCards();
 
+  void hasteHook(TraitEvent &event);
+  void challengerHook(TraitEvent &event);
+  void brutalHook(TraitEvent &event);
+  void lifestealHook(TraitEvent &event);
+  void venomousHook(TraitEvent &event);
+  void temporaryHook(TraitEvent &event);
+  void undyingHook(TraitEvent &event);
+  void regenerateHook(TraitEvent &event);
+  void poisonedHook(TraitEvent &event);
+
   std::string printRole(int player) const;
 };
 
@@ -0,0 +1,900 @@
+#include <algorithm>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "GameServer.hpp"
+#include "CommandLine.hpp"
+#include "Exeption.hpp"
+
+#define SESSION_MEMORY_MESSAGE "[ERROR] Not enough memory!"
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Creates a listening socket. A socket file left behind by a server that was killed is replaced, any
+/// other file at the path is kept.
+///
+/// @param socket_path path of the Unix domain socket
+///
+/// @return descriptor of the socket, -1 = failed
+static int listenOn(const std::string &socket_path)
+{
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (socket_path.empty() || socket_path.size() >= sizeof(address.sun_path))
+    return -1;
+  std::copy(socket_path.begin(), socket_path.end(), address.sun_path);
+
+  struct stat status;
+  if (lstat(socket_path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode))
+    unlink(socket_path.c_str());
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd >= 0 && (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+                  listen(fd, SOMAXCONN) != 0))
+  {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Creates the sockets for the players and the spectators and starts the workers. The server is not
+/// started if a path is taken by a file that is not a socket.
+///
+/// @param socket_path path of the Unix domain socket, the spectators connect to it with
+///                    SPECTATOR_SOCKET_SUFFIX appended
+/// @param prototype game every session starts from, it has to outlive the server
+/// @param workers number of worker threads that play the commands
+///
+/// @return nothing
+GameServer::GameServer(const std::string &socket_path, const Game &prototype, int workers)
+    : socket_path_(socket_path), spectator_path_(socket_path + SPECTATOR_SOCKET_SUFFIX), prototype_(prototype),
+      listen_fd_(-1), spectator_fd_(-1), epoll_fd_(-1), wake_fd_(-1), stopping_(false), next_session_id_(1),
+      workers_stopping_(false)
+{
+  listen_fd_ = listenOn(socket_path_);
+  spectator_fd_ = listenOn(spectator_path_);
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  bool failed = listen_fd_ < 0 || spectator_fd_ < 0 || epoll_fd_ < 0 || wake_fd_ < 0;
+  for (int fd : {listen_fd_, spectator_fd_, wake_fd_})
+  {
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    failed = failed || epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0;
+  }
+  if (failed)
+  {
+    closeDescriptors();
+    throw file_error(listen_fd_ < 0 ? socket_path_ : spectator_path_);
+  }
+
+  for (int worker = 0; worker < std::max(workers, 1); worker++)
+    workers_.emplace_back(&GameServer::work, this);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Stops the workers, closes all sessions and removes the socket file
+///
+/// @return nothing
+GameServer::~GameServer()
+{
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    workers_stopping_ = true;
+  }
+  queue_ready_.notify_all();
+  for (std::thread &worker : workers_)
+    worker.join();
+
+  for (const auto &session : sessions_)
+    close(session.first);
+  for (const auto &spectator : spectators_)
+    close(spectator.first);
+  closeDescriptors();
+  unlink(socket_path_.c_str());
+  unlink(spectator_path_.c_str());
+}
+
+void GameServer::closeDescriptors()
+{
+  for (int fd : {listen_fd_, spectator_fd_, epoll_fd_, wake_fd_})
+  {
+    if (fd >= 0)
+      close(fd);
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Runs the event loop until stop() is called
+///
+/// @return nothing
+void GameServer::run()
+{
+  epoll_event events[SERVER_EPOLL_EVENTS];
+  while (!stopping_.load())
+  {
+    int count = epoll_wait(epoll_fd_, events, SERVER_EPOLL_EVENTS, -1);
+    if (count < 0 && errno == EINTR)
+      continue;
+    if (count < 0)
+      return;
+
+    for (int index = 0; index < count; index++)
+    {
+      int fd = events[index].data.fd;
+      if (fd == listen_fd_)
+      {
+        acceptSessions();
+        continue;
+      }
+      if (fd == spectator_fd_)
+      {
+        acceptSpectators();
+        continue;
+      }
+      if (fd == wake_fd_)
+      {
+        uint64_t wakeups;
+        while (read(wake_fd_, &wakeups, sizeof(wakeups)) > 0)
+        {
+        }
+        collectPlayed();
+        continue;
+      }
+
+      auto watcher = spectators_.find(fd);
+      if (watcher != spectators_.end())
+      {
+        std::shared_ptr<Spectator> spectator = watcher->second;
+        // a spectator only hangs up when it is gone, there is no one left to send to
+        if (events[index].events & (EPOLLERR | EPOLLHUP))
+        {
+          closeSpectator(*spectator);
+          continue;
+        }
+        if (events[index].events & EPOLLOUT)
+          flushSpectator(*spectator);
+        if (spectator->fd >= 0 && (events[index].events & EPOLLIN))
+          readSpectator(*spectator);
+        if (spectator->fd >= 0)
+          updateSpectator(*spectator);
+        continue;
+      }
+
+      auto found = sessions_.find(fd);
+      if (found == sessions_.end())
+        continue;
+      std::shared_ptr<Session> session = found->second;
+      if (events[index].events & EPOLLERR)
+      {
+        closeSession(session);
+        continue;
+      }
+      if (events[index].events & EPOLLOUT)
+        flushSession(session);
+      if (session->fd >= 0 && (events[index].events & EPOLLOUT))
+        transferLines(session);
+      if (session->fd >= 0 && (events[index].events & (EPOLLIN | EPOLLHUP)))
+        readSession(session);
+      if (session->fd >= 0)
+        updateSession(session);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Lets run() return. Only writes to the wakeup descriptor, so it can be called from a signal handler.
+///
+/// @return nothing
+void GameServer::stop()
+{
+  stopping_.store(true);
+  uint64_t wakeup = 1;
+  [[maybe_unused]] ssize_t written = write(wake_fd_, &wakeup, sizeof(wakeup));
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Accepts all waiting connections, every connection starts a new game. Connections over the session
+/// limit are closed right away.
+///
+/// @return nothing
+void GameServer::acceptSessions()
+{
+  while (true)
+  {
+    int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0)
+      return;
+    if (sessions_.size() >= SERVER_MAX_SESSIONS)
+    {
+      close(fd);
+      continue;
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0)
+    {
+      close(fd);
+      continue;
+    }
+    std::shared_ptr<Session> session = std::make_shared<Session>();
+    session->fd = fd;
+    session->id = next_session_id_++;
+    session->view = std::make_shared<const BoardView>();
+    session->busy = true;
+    sessions_[fd] = session;
+    session_ids_[session->id] = session;
+    schedule(session);
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Reads what the client has sent, at most SERVER_READ_SIZE bytes per call. The rest stays in the socket
+/// until the next event, so a session that is no longer read leaves its input with the client.
+///
+/// @param session session to read
+///
+/// @return nothing
+void GameServer::readSession(const std::shared_ptr<Session> &session)
+{
+  char buffer[SERVER_READ_SIZE];
+  ssize_t received = recv(session->fd, buffer, sizeof(buffer), 0);
+  if (received < 0)
+  {
+    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+      closeSession(session);
+    return;
+  }
+
+  if (received == 0)
+  {
+    // the commands sent before the client shut down its side are still played
+    session->input_ended = true;
+    if (!session->input.empty())
+      session->input.push_back('\n');
+  }
+  else
+  {
+    session->input.append(buffer, received);
+  }
+  transferLines(session);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Moves the complete lines of the input to the commands of the session and hands the session to a
+/// worker if none is playing it. Lines stay in the input while the output is over its high-water mark.
+///
+/// @param session session with new input
+///
+/// @return nothing
+void GameServer::transferLines(const std::shared_ptr<Session> &session)
+{
+  bool start_worker = false;
+  {
+    std::lock_guard<std::mutex> lock(session->mutex);
+    if (session->finished)
+    {
+      session->input.clear();
+      return;
+    }
+
+    size_t start = 0;
+    size_t end;
+    while (session->pending.size() < SESSION_PENDING_LIMIT &&
+           session->output.size() <= SESSION_OUTPUT_HIGH_WATER &&
+           (end = session->input.find('\n', start)) != std::string::npos)
+    {
+      size_t length = end - start;
+      if (length && session->input[end - 1] == '\r')
+        length--;
+      session->pending.push_back(session->input.substr(start, length));
+      start = end + 1;
+    }
+    session->input.erase(0, start);
+
+    if (!session->busy && !session->pending.empty())
+    {
+      session->busy = true;
+      start_worker = true;
+    }
+  }
+
+  if (start_worker)
+    schedule(session);
+  if (session->input.size() > SESSION_LINE_LIMIT && session->input.find('\n') == std::string::npos)
+    closeSession(session);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Sends as much of the output of the session as the socket takes without blocking
+///
+/// @param session session to write
+///
+/// @return nothing
+void GameServer::flushSession(const std::shared_ptr<Session> &session)
+{
+  bool failed = false;
+  {
+    std::lock_guard<std::mutex> lock(session->mutex);
+    size_t written = 0;
+    while (written < session->output.size())
+    {
+      ssize_t sent = send(session->fd, session->output.data() + written, session->output.size() - written,
+                          MSG_NOSIGNAL | MSG_DONTWAIT);
+      if (sent < 0 && errno == EINTR)
+        continue;
+      if (sent < 0)
+      {
+        failed = errno != EAGAIN && errno != EWOULDBLOCK;
+        break;
+      }
+      written += sent;
+    }
+    session->output.erase(0, written);
+  }
+
+  if (failed)
+    closeSession(session);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Closes a session that is done or over its limits, otherwise registers the events it waits for: input
+/// while it has room for more commands and output, writing while output is waiting.
+///
+/// @param session session to update
+///
+/// @return nothing
+void GameServer::updateSession(const std::shared_ptr<Session> &session)
+{
+  bool done;
+  bool over_limit;
+  bool reading;
+  bool writing;
+  {
+    std::lock_guard<std::mutex> lock(session->mutex);
+    bool idle = !session->busy && session->pending.empty() && session->input.empty();
+    done = session->output.empty() && (session->finished || (session->input_ended && idle));
+    over_limit = session->output.size() > SESSION_OUTPUT_LIMIT;
+    reading = !session->input_ended && !session->finished && session->pending.size() < SESSION_PENDING_LIMIT &&
+              session->output.size() <= SESSION_OUTPUT_HIGH_WATER;
+    writing = !session->output.empty();
+  }
+  if (done || over_limit)
+  {
+    closeSession(session);
+    return;
+  }
+  if (reading == session->reading && writing == session->writing)
+    return;
+
+  epoll_event event{};
+  event.events = (reading ? static_cast<uint32_t>(EPOLLIN) : 0) | (writing ? static_cast<uint32_t>(EPOLLOUT) : 0);
+  event.data.fd = session->fd;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, session->fd, &event) != 0)
+  {
+    closeSession(session);
+    return;
+  }
+  session->reading = reading;
+  session->writing = writing;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Closes the connection of a session. A worker that is playing the session finishes its command, the
+/// game is released with the last reference to the session.
+///
+/// @param session session to close
+///
+/// @return nothing
+void GameServer::closeSession(const std::shared_ptr<Session> &session)
+{
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, session->fd, nullptr);
+  close(session->fd);
+  sessions_.erase(session->fd);
+  session_ids_.erase(session->id);
+  session->fd = -1;
+  session->input.clear();
+
+  // the spectators get the last changes and the end of the game, they are closed once it is sent
+  broadcastDeltas(session);
+  static const std::shared_ptr<const std::string> end_line = std::make_shared<const std::string>("X\n");
+  std::vector<int> spectators;
+  spectators.swap(session->spectators);
+  for (int fd : spectators)
+  {
+    auto found = spectators_.find(fd);
+    if (found == spectators_.end())
+      continue;
+    std::shared_ptr<Spectator> spectator = found->second;
+    spectator->session = 0;
+    spectator->closing = true;
+    queueSpectator(*spectator, end_line);
+    flushSpectator(*spectator);
+    if (spectator->fd >= 0)
+      updateSpectator(*spectator);
+  }
+
+  std::lock_guard<std::mutex> lock(session->mutex);
+  session->closed = true;
+  session->pending.clear();
+  session->output.clear();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Writes the output of the sessions the workers have played and gives them their next commands
+///
+/// @return nothing
+void GameServer::collectPlayed()
+{
+  std::vector<std::shared_ptr<Session>> played;
+  {
+    std::lock_guard<std::mutex> lock(played_mutex_);
+    played.swap(played_);
+  }
+
+  for (const std::shared_ptr<Session> &session : played)
+  {
+    if (session->fd >= 0)
+      broadcastDeltas(session);
+    if (session->fd >= 0)
+      transferLines(session);
+    if (session->fd >= 0)
+      flushSession(session);
+    if (session->fd >= 0)
+      updateSession(session);
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Queues the board changes the workers have made to a session for all of its spectators. Every change
+/// is one shared buffer, queuing it for a spectator does not copy it.
+///
+/// @param session session with new changes
+///
+/// @return nothing
+void GameServer::broadcastDeltas(const std::shared_ptr<Session> &session)
+{
+  std::vector<std::shared_ptr<const std::string>> deltas;
+  {
+    std::lock_guard<std::mutex> lock(session->mutex);
+    deltas.swap(session->deltas);
+    if (session->latest_view)
+      session->view = session->latest_view;
+  }
+  if (deltas.empty())
+    return;
+
+  std::vector<int> spectators = session->spectators;
+  for (int fd : spectators)
+  {
+    auto found = spectators_.find(fd);
+    if (found == spectators_.end())
+      continue;
+    std::shared_ptr<Spectator> spectator = found->second;
+    for (const std::shared_ptr<const std::string> &delta : deltas)
+    {
+      if (spectator->queued > SPECTATOR_OUTPUT_LIMIT)
+        break;
+      queueSpectator(*spectator, delta);
+    }
+    if (spectator->queued > SPECTATOR_OUTPUT_LIMIT)
+      resyncSpectator(*spectator, *session->view);
+    flushSpectator(*spectator);
+    if (spectator->fd >= 0)
+      updateSpectator(*spectator);
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Accepts all waiting spectator connections. Connections over the spectator limit are closed right
+/// away.
+///
+/// @return nothing
+void GameServer::acceptSpectators()
+{
+  while (true)
+  {
+    int fd = accept4(spectator_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0)
+      return;
+    if (spectators_.size() >= SERVER_MAX_SPECTATORS)
+    {
+      close(fd);
+      continue;
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0)
+    {
+      close(fd);
+      continue;
+    }
+    std::shared_ptr<Spectator> spectator = std::make_shared<Spectator>();
+    spectator->fd = fd;
+    spectators_[fd] = spectator;
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Reads the commands of a spectator. A spectator that ends its input keeps watching, one that does not
+/// watch a session is closed then.
+///
+/// @param spectator spectator to read
+///
+/// @return nothing
+void GameServer::readSpectator(Spectator &spectator)
+{
+  char buffer[SERVER_READ_SIZE];
+  ssize_t received = recv(spectator.fd, buffer, sizeof(buffer), 0);
+  if (received < 0)
+  {
+    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+      closeSpectator(spectator);
+    return;
+  }
+  if (received == 0)
+  {
+    spectator.input_ended = true;
+    if (!spectator.input.empty())
+      spectator.input.push_back('\n');
+  }
+  else
+  {
+    spectator.input.append(buffer, received);
+  }
+
+  size_t start = 0;
+  size_t end;
+  while (spectator.fd >= 0 && (end = spectator.input.find('\n', start)) != std::string::npos)
+  {
+    size_t length = end - start;
+    if (length && spectator.input[end - 1] == '\r')
+      length--;
+    handleSpectatorLine(spectator, spectator.input.substr(start, length));
+    start = end + 1;
+  }
+  if (spectator.fd < 0)
+    return;
+  spectator.input.erase(0, start);
+
+  if (spectator.input.size() > SESSION_LINE_LIMIT)
+    closeSpectator(spectator);
+  else if (spectator.input_ended && !spectator.session)
+    spectator.closing = true;
+  if (spectator.fd >= 0 && spectator.closing)
+    flushSpectator(spectator);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Plays a command of a spectator: "list" lists the running sessions with their rounds, "watch <id>"
+/// sends the board of a session and from then on its changes, "quit" closes the connection
+///
+/// @param spectator spectator that sent the command
+/// @param line command
+///
+/// @return nothing
+void GameServer::handleSpectatorLine(Spectator &spectator, const std::string &line)
+{
+  std::istringstream words(line);
+  std::string command;
+  words >> command;
+  if (command.empty())
+    return;
+
+  if (command == "list")
+  {
+    std::string text;
+    for (const auto &session : session_ids_)
+      text += "L " + std::to_string(session.first) + " " + std::to_string(session.second->view->getRound()) + "\n";
+    queueSpectator(spectator, std::make_shared<const std::string>(text + ".\n"));
+    return;
+  }
+  if (command == "quit")
+  {
+    spectator.closing = true;
+    return;
+  }
+
+  unsigned long id = 0;
+  auto found = session_ids_.end();
+  if (command == "watch" && words >> id)
+    found = session_ids_.find(id);
+  if (found == session_ids_.end())
+  {
+    static const std::shared_ptr<const std::string> unknown_line =
+        std::make_shared<const std::string>("! unknown command or session\n");
+    queueSpectator(spectator, unknown_line);
+    return;
+  }
+
+  detachSpectator(spectator);
+  spectator.session = id;
+  found->second->spectators.push_back(spectator.fd);
+  resyncSpectator(spectator, *found->second->view);
+}
+
+void GameServer::queueSpectator(Spectator &spectator, const std::shared_ptr<const std::string> &text)
+{
+  spectator.output.push_back(text);
+  spectator.queued += text->size();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Replaces the queued output of a spectator with the whole board. Only a buffer that is partly sent is
+/// kept, so the spectator never gets half a line.
+///
+/// @param spectator spectator to start over
+/// @param view board the spectator gets
+///
+/// @return nothing
+void GameServer::resyncSpectator(Spectator &spectator, const BoardView &view)
+{
+  while (spectator.output.size() > (spectator.sent ? 1 : 0))
+  {
+    spectator.queued -= spectator.output.back()->size();
+    spectator.output.pop_back();
+  }
+  queueSpectator(spectator, std::make_shared<const std::string>(view.encodeKeyframe()));
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Sends as much of the output of a spectator as the socket takes without blocking and closes a spectator
+/// that is done once everything is sent
+///
+/// @param spectator spectator to write
+///
+/// @return nothing
+void GameServer::flushSpectator(Spectator &spectator)
+{
+  while (!spectator.output.empty())
+  {
+    const std::string &text = *spectator.output.front();
+    ssize_t sent = send(spectator.fd, text.data() + spectator.sent, text.size() - spectator.sent,
+                        MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (sent < 0 && errno == EINTR)
+      continue;
+    if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return;
+    if (sent < 0)
+    {
+      closeSpectator(spectator);
+      return;
+    }
+    spectator.sent += sent;
+    spectator.queued -= sent;
+    if (spectator.sent == text.size())
+    {
+      spectator.output.pop_front();
+      spectator.sent = 0;
+    }
+  }
+  if (spectator.closing)
+    closeSpectator(spectator);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Registers the events a spectator waits for: input until it has ended and writing while output is
+/// waiting
+///
+/// @param spectator spectator to update
+///
+/// @return nothing
+void GameServer::updateSpectator(Spectator &spectator)
+{
+  bool reading = !spectator.input_ended;
+  bool writing = !spectator.output.empty();
+  if (reading == spectator.reading && writing == spectator.writing)
+    return;
+
+  epoll_event event{};
+  event.events = (reading ? static_cast<uint32_t>(EPOLLIN) : 0) | (writing ? static_cast<uint32_t>(EPOLLOUT) : 0);
+  event.data.fd = spectator.fd;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, spectator.fd, &event) != 0)
+  {
+    closeSpectator(spectator);
+    return;
+  }
+  spectator.reading = reading;
+  spectator.writing = writing;
+}
+
+void GameServer::detachSpectator(Spectator &spectator)
+{
+  auto found = session_ids_.find(spectator.session);
+  if (found != session_ids_.end())
+  {
+    std::vector<int> &spectators = found->second->spectators;
+    spectators.erase(std::remove(spectators.begin(), spectators.end(), spectator.fd), spectators.end());
+  }
+  spectator.session = 0;
+}
+
+void GameServer::closeSpectator(Spectator &spectator)
+{
+  detachSpectator(spectator);
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, spectator.fd, nullptr);
+  close(spectator.fd);
+  int fd = spectator.fd;
+  spectator.fd = -1;
+  spectator.output.clear();
+  spectator.queued = 0;
+  spectators_.erase(fd);
+}
+
+void GameServer::schedule(const std::shared_ptr<Session> &session)
+{
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    queue_.push_back(session);
+  }
+  queue_ready_.notify_one();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Worker thread: plays one command of a session at a time, so long games do not hold up the others,
+/// and hands the output to the event loop
+///
+/// @return nothing
+void GameServer::work()
+{
+  while (true)
+  {
+    std::shared_ptr<Session> session;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      queue_ready_.wait(lock, [this]
+                        { return workers_stopping_ || !queue_.empty(); });
+      if (workers_stopping_)
+        return;
+      session = queue_.front();
+      queue_.pop_front();
+    }
+
+    bool play_again = playSession(*session);
+    {
+      std::lock_guard<std::mutex> lock(played_mutex_);
+      played_.push_back(session);
+    }
+    uint64_t wakeup = 1;
+    [[maybe_unused]] ssize_t written = write(wake_fd_, &wakeup, sizeof(wakeup));
+    if (play_again)
+      schedule(session);
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Starts the game of a new session or plays its next command, like the game loop of the command line
+///
+/// @param session session to play, it is busy, so no other worker plays it
+///
+/// @return true = more commands are waiting, the session stays busy
+bool GameServer::playSession(Session &session)
+{
+  bool starting = session.game == nullptr;
+  std::string line;
+  {
+    std::lock_guard<std::mutex> lock(session.mutex);
+    if (session.closed)
+    {
+      session.busy = false;
+      return false;
+    }
+    if (!starting)
+    {
+      line = session.pending.front();
+      session.pending.pop_front();
+    }
+  }
+
+  bool finished = false;
+  try
+  {
+    if (starting)
+    {
+      session.game = std::make_unique<Game>(prototype_);
+      session.game->setOutputStream(&session.out);
+      session.game->printWelcome();
+      session.turns = std::make_unique<TurnSession>(TurnSession::play(*session.game, true));
+    }
+    else
+    {
+      session.turns->resume(CommandLine::parseCommand(line));
+    }
+
+    finished = session.turns->isFinished();
+    publishBoard(session, finished ? session.turns->getGameStatus() : 0);
+    if (finished && session.turns->getGameStatus())
+      session.game->endGame(session.turns->getGameStatus(), "");
+    else if (!finished)
+      session.out << std::endl
+                  << "P" << session.turns->getPlayer() << "> ";
+  }
+  catch (const MemoryEx &e)
+  {
+    session.out << SESSION_MEMORY_MESSAGE << std::endl;
+    finished = true;
+  }
+  if (finished)
+  {
+    session.turns.reset();
+    session.game.reset();
+  }
+
+  std::string text = session.out.str();
+  session.out.str("");
+
+  std::lock_guard<std::mutex> lock(session.mutex);
+  if (session.closed)
+  {
+    session.busy = false;
+    return false;
+  }
+  session.output += text;
+  if (finished)
+  {
+    session.finished = true;
+    session.pending.clear();
+  }
+  if (!session.finished && !session.pending.empty())
+    return true;
+  session.busy = false;
+  return false;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Compares the board with the one before the command and hands the changes to the event loop. This is
+/// done once per command, however many spectators watch the session.
+///
+/// @param session session that played a command
+/// @param game_status status of the game if it has ended, 0 = still running or quit
+///
+/// @return nothing
+void GameServer::publishBoard(Session &session, int game_status)
+{
+  BoardView board(*session.game);
+  std::string delta = board.encodeDelta(session.board);
+  if (game_status)
+    delta += "W " + std::to_string(Game::winnerFromStatus(game_status)) + "\n.\n";
+  if (delta.empty())
+    return;
+  session.board = board;
+
+  std::shared_ptr<const std::string> text = std::make_shared<const std::string>(std::move(delta));
+  std::shared_ptr<const BoardView> view = std::make_shared<const BoardView>(board);
+  std::lock_guard<std::mutex> lock(session.mutex);
+  session.deltas.push_back(std::move(text));
+  session.latest_view = std::move(view);
+}
@@ -0,0 +1,153 @@
+#ifndef GAMESERVER_HPP
+#define GAMESERVER_HPP
+
+#include <string>
+#include <sstream>
+#include <map>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+
+#include "Game.hpp"
+#include "TurnSession.hpp"
+#include "BoardDelta.hpp"
+
+#define SERVER_MAX_SESSIONS 4096
+#define SERVER_WORKER_COUNT 4
+#define SERVER_EPOLL_EVENTS 256
+#define SERVER_READ_SIZE 4096
+#define SESSION_LINE_LIMIT 1024
+#define SESSION_PENDING_LIMIT 16
+#define SESSION_OUTPUT_HIGH_WATER 65536
+#define SESSION_OUTPUT_LIMIT 1048576
+#define SERVER_MAX_SPECTATORS 4096
+#define SPECTATOR_SOCKET_SUFFIX ".spectate"
+#define SPECTATOR_OUTPUT_LIMIT 262144
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Hosts many games on a Unix domain socket. Every connection is one session, a hot-seat game of two
+/// humans that speaks the command grammar of the command line, one command per line. A single thread
+/// runs the epoll loop: it accepts the connections, splits the input into lines and writes the output
+/// back. The commands are played by a small pool of workers, a session is only played by one worker at
+/// a time. Each session plays a copy of the prototype game, so all of them share its messages and
+/// codebooks and only own their players, board and arena.
+///
+/// Backpressure: a session is no longer read while it has SESSION_PENDING_LIMIT unplayed commands or
+/// more than SESSION_OUTPUT_HIGH_WATER bytes of unsent output, the client then blocks on its own socket.
+/// A session that sends a line longer than SESSION_LINE_LIMIT or does not read its output until it
+/// exceeds SESSION_OUTPUT_LIMIT is closed.
+///
+/// Spectators connect to the socket path with SPECTATOR_SOCKET_SUFFIX appended. The worker compares the
+/// board before and after every command once and hands the changes to the event loop as one immutable
+/// buffer, which is queued for every spectator of the session, so the game thread does the same work for
+/// one spectator as for a thousand. A spectator that falls more than SPECTATOR_OUTPUT_LIMIT bytes behind
+/// loses its queued changes and gets the whole board again.
+///
+class GameServer
+{
+public:
+  // Forward declarations
+  GameServer(const std::string &socket_path, const Game &prototype, int workers = SERVER_WORKER_COUNT);
+  GameServer(const GameServer &) = delete;
+  ~GameServer();
+
+  void run();
+  void stop();
+
+private:
+  struct Session
+  {
+    // only used by the event loop
+    int fd;
+    unsigned long id;
+    std::string input;
+    bool reading = true;
+    bool writing = false;
+    bool input_ended = false;
+    std::vector<int> spectators;
+    std::shared_ptr<const BoardView> view;
+
+    // shared with the workers
+    std::mutex mutex;
+    std::deque<std::string> pending;
+    std::string output;
+    bool busy = false;
+    bool finished = false;
+    bool closed = false;
+    std::vector<std::shared_ptr<const std::string>> deltas;
+    std::shared_ptr<const BoardView> latest_view;
+
+    // only used by the worker that plays the session
+    std::unique_ptr<Game> game;
+    std::unique_ptr<TurnSession> turns;
+    std::ostringstream out;
+    BoardView board;
+  };
+
+  // only used by the event loop
+  struct Spectator
+  {
+    int fd;
+    std::string input;
+    std::deque<std::shared_ptr<const std::string>> output;
+    size_t sent = 0;
+    size_t queued = 0;
+    unsigned long session = 0;
+    bool reading = true;
+    bool writing = false;
+    bool input_ended = false;
+    bool closing = false;
+  };
+
+  std::string socket_path_;
+  std::string spectator_path_;
+  const Game &prototype_;
+  int listen_fd_;
+  int spectator_fd_;
+  int epoll_fd_;
+  int wake_fd_;
+  std::atomic<bool> stopping_;
+  std::map<int, std::shared_ptr<Session>> sessions_;
+  std::map<unsigned long, std::shared_ptr<Session>> session_ids_;
+  unsigned long next_session_id_;
+  std::map<int, std::shared_ptr<Spectator>> spectators_;
+
+  std::mutex queue_mutex_;
+  std::condition_variable queue_ready_;
+  std::deque<std::shared_ptr<Session>> queue_;
+  bool workers_stopping_;
+  std::vector<std::thread> workers_;
+
+  std::mutex played_mutex_;
+  std::vector<std::shared_ptr<Session>> played_;
+
+  void closeDescriptors();
+  void acceptSessions();
+  void readSession(const std::shared_ptr<Session> &session);
+  void transferLines(const std::shared_ptr<Session> &session);
+  void flushSession(const std::shared_ptr<Session> &session);
+  void updateSession(const std::shared_ptr<Session> &session);
+  void closeSession(const std::shared_ptr<Session> &session);
+  void collectPlayed();
+  void broadcastDeltas(const std::shared_ptr<Session> &session);
+  void acceptSpectators();
+  void readSpectator(Spectator &spectator);
+  void handleSpectatorLine(Spectator &spectator, const std::string &line);
+  void queueSpectator(Spectator &spectator, const std::shared_ptr<const std::string> &text);
+  void resyncSpectator(Spectator &spectator, const BoardView &view);
+  void flushSpectator(Spectator &spectator);
+  void updateSpectator(Spectator &spectator);
+  void detachSpectator(Spectator &spectator);
+  void closeSpectator(Spectator &spectator);
+  void schedule(const std::shared_ptr<Session> &session);
+  void work();
+  bool playSession(Session &session);
+  void publishBoard(Session &session, int game_status);
+};
+
+#endif
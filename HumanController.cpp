@@ -0,0 +1,30 @@
+#include "HumanController.hpp"
+
+HumanController::HumanController(CommandLine &command_line, int player)
+    : command_line_(command_line), player_(player) {}
+
+void HumanController::startTurn(const Game &)
+{
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// The command of a human is read when it is taken, so it is always ready
+///
+/// @param timeout not used
+///
+/// @return always true
+bool HumanController::waitForAction(std::chrono::milliseconds)
+{
+  return true;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Prompts for a command and waits until the user has entered it
+///
+/// @return entered command
+Command HumanController::takeAction()
+{
+  return command_line_.readCommand(player_);
+}
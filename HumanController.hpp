@@ -0,0 +1,28 @@
+#ifndef HUMANCONTROLLER_HPP
+#define HUMANCONTROLLER_HPP
+
+#include "PlayerController.hpp"
+#include "CommandLine.hpp"
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Player that enters the actions on the command line
+///
+class HumanController : public PlayerController
+{
+protected:
+  CommandLine &command_line_;
+  int player_;
+
+public:
+  // Forward declarations
+  HumanController(CommandLine &command_line, int player);
+  ~HumanController() override = default;
+
+  void startTurn(const Game &game) override;
+  bool waitForAction(std::chrono::milliseconds timeout) override;
+  Command takeAction() override;
+  bool isHuman() const override { return true; }
+};
+
+#endif
@@ -5,13 +5,14 @@
 #include "Init.hpp"
 #include "Card.hpp"
 #include "Player.hpp"
+#include "CardCodebook.hpp"
 
 Init::Init(Player &player1, Player &player2, char *argv[])
     : player1_(player1), player2_(player2), max_rounds_(0)
 {
   config_file_name_ = argv[1];
   message_file_name_ = argv[2];
-  card_file_name_ = "data/card_codebook.txt";
+  card_file_name_ = CARD_CODEBOOK_FILE;
 }
 
 Init::~Init() {}
@@ -80,8 +81,6 @@ void Init::parseDeckLines(std::string line, Player& player)
     deck_line.erase(0, pos + 1);
 
     std::shared_ptr<Card> card = Card::createCardFromID(ID);
-    std::string effect = infos_["I_" + ID];
-    card->changeEffect(effect);
 
     player.addCardToDeck(card);
   }
@@ -142,135 +141,14 @@ void Init::parseMessageLines()
 
 //-----------------------------------------------------------------------------------------------------
 ///
-/// Loads the creatures from the self defined card codebook file
+/// Loads the creatures and spells from the self defined card codebook file. The codebook is read from
+/// its compiled image if that is up to date, otherwise the text is parsed once and compiled again.
 ///
 /// @return nothing
-void Init::loadCreatureCodes()
+void Init::loadCardCodes()
 {
-  std::ifstream config_file(card_file_name_);
-  if (!config_file.is_open())
-  {
-    throw file_error(card_file_name_);
-  }
-  std::string line;
-  bool in_creature_section = false;
-
-  while (std::getline(config_file, line))
-  {
-    if (line.empty())
-    {
-      continue;
-    }
-    if (line == "creature")
-    {
-      in_creature_section = true;
-      continue;
-    }
-    else if (line == "spell")
-    {
-      break;
-    }
-
-    if (in_creature_section)
-    {
-      auto creature = std::make_shared<Creature>();
-      std::string deck_line = line;
-      int pos = 0;
-      pos = deck_line.find(';');
-      creature->setManaCost(std::stoi(deck_line.substr(0, pos)));
-      deck_line.erase(0, pos + 1);
-
-      pos = deck_line.find(';');
-      creature->setCardID(deck_line.substr(0, pos));
-      deck_line.erase(0, pos + 1);
-
-      pos = deck_line.find(';');
-      creature->setCardName(deck_line.substr(0, pos));
-      deck_line.erase(0, pos + 1);
-
-      pos = deck_line.find(';');
-      std::string traits_str = deck_line.substr(0, pos);
-      deck_line.erase(0, pos + 1);
-
-      std::vector<Trait> traits;
-      for (char ch : traits_str)
-      {
-        traits.push_back(creature->traitFromChar(ch));
-      }
-
-      creature->setBaseTraits(traits);
-
-      pos = deck_line.find(';');
-      creature->setBaseAttack(std::stoi(deck_line.substr(0, pos)));
-      deck_line.erase(0, pos + 1);
-
-      creature->setBaseHealth(std::stoi(deck_line));
-
-      creature_codebook_.push_back(creature);
-    }
-  }
-  config_file.close();
-}
-
-//-----------------------------------------------------------------------------------------------------
-///
-/// Loads the spells from the self defined card codebook file
-///
-/// @return nothing
-void Init::loadSpellCodes()
-{
-  std::ifstream config_file(card_file_name_);
-  if (!config_file.is_open())
-  {
-    throw file_error(card_file_name_);
-  }
-  std::string line;
-  bool in_spell_section = false;
-
-  while (std::getline(config_file, line))
-  {
-    if (line.empty())
-    {
-      continue;
-    }
-    if (line == "spell")
-    {
-      in_spell_section = true;
-      continue;
-    }
-
-    if (in_spell_section)
-    {
-      auto spell = std::make_shared<Spell>();
-      std::string deck_line = line;
-      int pos = 0;
-
-      pos = deck_line.find(';');
-      if (deck_line.substr(0, pos) == "x")
-      {
-        spell->setXXManaCost();
-      }
-      else
-      {
-        spell->setManaCost(std::stoi(deck_line.substr(0, pos)));
-      }
-      deck_line.erase(0, pos + 1);
-
-      pos = deck_line.find(';');
-      spell->setCardID(deck_line.substr(0, pos));
-      deck_line.erase(0, pos + 1);
-
-      pos = deck_line.find(';');
-      spell->setCardName(deck_line.substr(0, pos));
-      deck_line.erase(0, pos + 1);
-
-      spell->setEffect(deck_line);
-
-      spell_codebook_.push_back(spell);
-    }
-  }
-
-  config_file.close();
+  CardCodebook codebook(card_file_name_, CARD_CODEBOOK_IMAGE_FILE);
+  codebook.createCards(creature_codebook_, spell_codebook_);
 }
 
 const std::vector<std::shared_ptr<Creature>> Init::getCreatureCodebook() const
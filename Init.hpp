@@ -36,8 +36,7 @@ public:
   void parseDeckLines(std::string line, Player &player);
   void parseMessageLines();
 
-  void loadCreatureCodes();
-  void loadSpellCodes();
+  void loadCardCodes();
 
   bool loadCards();
 
@@ -0,0 +1,253 @@
+#include <algorithm>
+
+#include "JobScheduler.hpp"
+#include "AllocationTracker.hpp"
+
+static thread_local JobScheduler *current_scheduler = nullptr;
+static thread_local unsigned int current_worker = 0;
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Starts the workers
+///
+/// @param workers number of worker threads, the threads waiting for jobs run jobs as well
+///
+/// @return nothing
+JobScheduler::JobScheduler(unsigned int workers) : queued_(0), stopping_(false)
+{
+  for (unsigned int queue = 0; queue <= workers; queue++)
+    queues_.push_back(std::make_unique<JobQueue>());
+  for (unsigned int worker = 0; worker < workers; worker++)
+    workers_.emplace_back(&JobScheduler::work, this, worker);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Runs the jobs that are still queued and stops the workers
+///
+/// @return nothing
+JobScheduler::~JobScheduler()
+{
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread &worker : workers_)
+    worker.join();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Returns the scheduler of the program, it uses all cores: one worker less than the hardware threads,
+/// because the thread waiting for the jobs runs them as well
+///
+/// @return shared scheduler
+JobScheduler &JobScheduler::shared()
+{
+  static JobScheduler scheduler(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+  return scheduler;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Queues a job. A worker of this scheduler queues it in its own deque, any other thread in the shared
+/// one.
+///
+/// @param job job to queue
+///
+/// @return nothing
+void JobScheduler::submit(const Job &job)
+{
+  unsigned int queue = current_scheduler == this ? current_worker : queues_.size() - 1;
+  {
+    std::lock_guard<std::mutex> lock(queues_[queue]->mutex);
+    queues_[queue]->jobs.push_back(job);
+  }
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    queued_.fetch_add(1);
+  }
+  wake_.notify_one();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Takes the next job: a worker takes the newest job of its own deque first, otherwise the oldest job of
+/// another deque is stolen
+///
+/// @param job gets the job
+///
+/// @return true = job taken, false = all deques are empty
+bool JobScheduler::takeJob(Job &job)
+{
+  bool is_worker = current_scheduler == this;
+  if (is_worker)
+  {
+    JobQueue &own = *queues_[current_worker];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.jobs.empty())
+    {
+      job = own.jobs.back();
+      own.jobs.pop_back();
+      queued_.fetch_sub(1);
+      return true;
+    }
+  }
+
+  unsigned int first = is_worker ? current_worker + 1 : 0;
+  for (unsigned int offset = 0; offset < queues_.size(); offset++)
+  {
+    JobQueue &victim = *queues_[(first + offset) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.jobs.empty())
+    {
+      job = victim.jobs.front();
+      victim.jobs.pop_front();
+      queued_.fetch_sub(1);
+      return true;
+    }
+  }
+  return false;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Runs one queued job on the calling thread
+///
+/// @return true = a job was run, false = no job was queued
+bool JobScheduler::runOne()
+{
+  Job job;
+  if (!takeJob(job))
+    return false;
+
+  // the jobs' allocations go to the totals before the group sees them finish, the thread may never end
+  bool track_allocations = AllocationTracker::isEnabled();
+  AllocationSnapshot before = track_allocations ? AllocationTracker::threadSnapshot() : AllocationSnapshot();
+  std::exception_ptr exception = nullptr;
+  try
+  {
+    job.function(job.storage);
+  }
+  catch (...)
+  {
+    exception = std::current_exception();
+  }
+  if (track_allocations)
+    AllocationTracker::rollupSince(before);
+  job.group->finishJob(exception);
+  return true;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Blocks the calling thread until a job is queued or the pending jobs of a group have finished
+///
+/// @param pending number of pending jobs of the group the thread waits for
+///
+/// @return nothing
+void JobScheduler::waitForWork(const std::atomic<long> &pending)
+{
+  std::unique_lock<std::mutex> lock(sleep_mutex_);
+  wake_.wait(lock, [this, &pending]
+             { return queued_.load() > 0 || pending.load() == 0; });
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Wakes all threads waiting in waitForWork, e.g. when the last job of a group has finished
+///
+/// @return nothing
+void JobScheduler::notifyAll()
+{
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+  }
+  wake_.notify_all();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Worker thread: runs jobs until the scheduler is destroyed
+///
+/// @param worker index of the worker and its deque
+///
+/// @return nothing
+void JobScheduler::work(unsigned int worker)
+{
+  current_scheduler = this;
+  current_worker = worker;
+  while (true)
+  {
+    if (runOne())
+      continue;
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    wake_.wait(lock, [this]
+               { return stopping_ || queued_.load() > 0; });
+    if (stopping_ && queued_.load() == 0)
+      return;
+  }
+}
+
+JobGroup::JobGroup(JobScheduler &scheduler) : scheduler_(scheduler), pending_(0), exception_(nullptr) {}
+
+JobGroup::~JobGroup()
+{
+  // jobs refer to the group, it must not go away before they have finished
+  join();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Waits until all jobs of the group have finished, the waiting thread runs queued jobs meanwhile
+///
+/// @return nothing
+void JobGroup::join()
+{
+  while (pending_.load() > 0)
+  {
+    if (!scheduler_.runOne())
+      scheduler_.waitForWork(pending_);
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Waits until all jobs of the group have finished and passes on the first exception of a job
+///
+/// @return nothing
+void JobGroup::wait()
+{
+  join();
+
+  std::exception_ptr exception = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(exception_mutex_);
+    std::swap(exception, exception_);
+  }
+  if (exception)
+    std::rethrow_exception(exception);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Marks a job of the group as finished, called by the thread that ran it
+///
+/// @param exception exception thrown by the job, nullptr = none
+///
+/// @return nothing
+void JobGroup::finishJob(std::exception_ptr exception)
+{
+  if (exception)
+  {
+    std::lock_guard<std::mutex> lock(exception_mutex_);
+    if (!exception_)
+      exception_ = exception;
+  }
+
+  // the group may be destroyed as soon as the count reaches zero
+  JobScheduler &scheduler = scheduler_;
+  if (pending_.fetch_sub(1) == 1)
+    scheduler.notifyAll();
+}
@@ -0,0 +1,126 @@
+#ifndef JOBSCHEDULER_HPP
+#define JOBSCHEDULER_HPP
+
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <cstring>
+#include <cstddef>
+#include <type_traits>
+#include <condition_variable>
+
+#define JOB_STORAGE_SIZE 64
+
+class JobGroup;
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// A job as it is queued: a function and its captured values, copied into the job itself, so queuing a
+/// job never allocates
+///
+struct Job
+{
+  void (*function)(void *storage);
+  JobGroup *group;
+  alignas(std::max_align_t) unsigned char storage[JOB_STORAGE_SIZE];
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Work-stealing pool of worker threads. Every worker has its own deque: it pushes and pops its jobs at
+/// the back, idle workers steal from the front of the others. Jobs queued by other threads go to a
+/// shared deque that is stolen from the same way. A thread that waits for a JobGroup runs jobs as well,
+/// so a scheduler with N workers runs N + 1 jobs at a time and one without workers runs every job on the
+/// waiting thread. Jobs should end on their own or at a deadline, a waiting thread may pick up any job.
+///
+class JobScheduler
+{
+public:
+  // Forward declarations
+  explicit JobScheduler(unsigned int workers);
+  JobScheduler(const JobScheduler &) = delete;
+  ~JobScheduler();
+
+  static JobScheduler &shared();
+
+  unsigned int getConcurrency() const { return workers_.size() + 1; }
+  void submit(const Job &job);
+  bool runOne();
+  void waitForWork(const std::atomic<long> &pending);
+  void notifyAll();
+
+private:
+  struct JobQueue
+  {
+    std::mutex mutex;
+    std::deque<Job> jobs;
+  };
+
+  // one deque per worker, the last one is shared by all other threads
+  std::vector<std::unique_ptr<JobQueue>> queues_;
+  std::vector<std::thread> workers_;
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  std::atomic<long> queued_;
+  bool stopping_;
+
+  bool takeJob(Job &job);
+  void work(unsigned int worker);
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Fork-join helper: jobs are started with run() and wait() returns when all of them have finished.
+/// The first exception thrown by a job is passed on by wait(). The captured values of a job have to be
+/// trivially copyable and fit into JOB_STORAGE_SIZE bytes, e.g. pointers, references and numbers.
+///
+class JobGroup
+{
+protected:
+  JobScheduler &scheduler_;
+  std::atomic<long> pending_;
+  std::mutex exception_mutex_;
+  std::exception_ptr exception_;
+
+  void join();
+
+public:
+  // Forward declarations
+  explicit JobGroup(JobScheduler &scheduler = JobScheduler::shared());
+  JobGroup(const JobGroup &) = delete;
+  ~JobGroup();
+
+  template <typename Function>
+  void run(const Function &function);
+  bool isFinished() const { return pending_.load() == 0; }
+  void wait();
+  void finishJob(std::exception_ptr exception);
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Starts a job of the group
+///
+/// @param function callable without parameters, it is copied into the job
+///
+/// @return nothing
+template <typename Function>
+void JobGroup::run(const Function &function)
+{
+  static_assert(std::is_trivially_copyable_v<Function> && sizeof(Function) <= JOB_STORAGE_SIZE &&
+                    alignof(Function) <= alignof(std::max_align_t),
+                "job does not fit into a Job");
+  Job job;
+  job.function = [](void *storage)
+  { (*static_cast<Function *>(storage))(); };
+  job.group = this;
+  std::memcpy(job.storage, &function, sizeof(Function));
+  pending_.fetch_add(1);
+  scheduler_.submit(job);
+}
+
+#endif
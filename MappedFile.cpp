@@ -0,0 +1,84 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MappedFile.hpp"
+#include "Exeption.hpp"
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Opens and maps a file, throws a file_error if that is not possible
+///
+/// @param file_name path to the file
+/// @param writable true = map for reading and writing, false = map read-only
+/// @param create_size size of the file if it has to be created, 0 = the file has to exist already.
+///                    Only used for writable mappings, new files are filled with zeros.
+///
+/// @return nothing
+MappedFile::MappedFile(const std::string &file_name, bool writable, size_t create_size)
+    : file_name_(file_name), file_descriptor_(-1), data_(nullptr), size_(0), was_created_(false)
+{
+  int flags = writable ? O_RDWR : O_RDONLY;
+  if (writable && create_size > 0)
+    flags |= O_CREAT;
+
+  file_descriptor_ = open(file_name_.c_str(), flags, 0644);
+  if (file_descriptor_ < 0)
+  {
+    throw file_error(file_name_);
+  }
+
+  struct stat file_status;
+  if (fstat(file_descriptor_, &file_status) != 0)
+  {
+    close(file_descriptor_);
+    throw file_error(file_name_);
+  }
+
+  size_ = file_status.st_size;
+  if (size_ == 0 && writable && create_size > 0)
+  {
+    if (ftruncate(file_descriptor_, create_size) != 0)
+    {
+      close(file_descriptor_);
+      throw file_error(file_name_);
+    }
+    size_ = create_size;
+    was_created_ = true;
+  }
+  if (size_ == 0)
+  {
+    close(file_descriptor_);
+    throw file_error(file_name_);
+  }
+
+  int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+  data_ = mmap(nullptr, size_, protection, MAP_SHARED, file_descriptor_, 0);
+  if (data_ == MAP_FAILED)
+  {
+    close(file_descriptor_);
+    throw file_error(file_name_);
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Unmaps and closes the file, changes of writable mappings are written back by the system
+///
+/// @return nothing
+MappedFile::~MappedFile()
+{
+  munmap(data_, size_);
+  close(file_descriptor_);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Schedules writing the changes of the mapping back to the file
+///
+/// @return nothing
+void MappedFile::sync()
+{
+  msync(data_, size_, MS_ASYNC);
+}
@@ -0,0 +1,34 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <string>
+#include <cstddef>
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// A file mapped into memory. Writable mappings are shared, so changes end up in the file; read-only
+/// mappings share their pages between all processes that map the same file.
+///
+class MappedFile
+{
+protected:
+  std::string file_name_;
+  int file_descriptor_;
+  void *data_;
+  size_t size_;
+  bool was_created_;
+
+public:
+  // Forward declarations
+  MappedFile(const std::string &file_name, bool writable, size_t create_size = 0);
+  MappedFile(const MappedFile &) = delete;
+  ~MappedFile();
+
+  void *getData() const { return data_; }
+  size_t getSize() const { return size_; }
+  bool wasCreated() const { return was_created_; }
+  const std::string &getFileName() const { return file_name_; }
+  void sync();
+};
+
+#endif
@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <sstream>
+#include <vector>
+#include <unordered_set>
+
+#include "OpeningBook.hpp"
+#include "Exeption.hpp"
+#include "Game.hpp"
+#include "Bot.hpp"
+#include "CardCodebook.hpp"
+
+#define OPENING_BOOK_MAGIC "MOOPBOOK"
+#define OPENING_BOOK_VERSION 2
+
+struct OpeningBookHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t entry_size;
+  uint64_t capacity;
+  uint64_t codebook_checksum;
+  uint32_t rules_version;
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Opens the book file. Writable books are created empty if the file does not exist yet, read-only
+/// books have to exist. A book built with another codebook or other rules is emptied when it is opened
+/// for building and not used for playing.
+///
+/// @param file_name path to the book file
+/// @param writable true = open for building, false = open for playing
+/// @param capacity number of entries of a newly created book, has to be a power of two
+///
+/// @return nothing
+OpeningBook::OpeningBook(const std::string &file_name, bool writable, uint64_t capacity)
+    : entries_(nullptr), capacity_(capacity)
+{
+  file_ = std::make_unique<MappedFile>(file_name, writable,
+                                       writable ? sizeof(OpeningBookHeader) + capacity_ * sizeof(Entry) : 0);
+
+  OpeningBookHeader *header = static_cast<OpeningBookHeader *>(file_->getData());
+  if (file_->wasCreated())
+  {
+    std::memcpy(header->magic, OPENING_BOOK_MAGIC, sizeof(header->magic));
+    header->version = OPENING_BOOK_VERSION;
+    header->entry_size = sizeof(Entry);
+    header->capacity = capacity_;
+    header->codebook_checksum = CardCodebook::getLoadedChecksum();
+    header->rules_version = GAME_RULES_VERSION;
+  }
+  else if (file_->getSize() < sizeof(OpeningBookHeader) ||
+           std::memcmp(header->magic, OPENING_BOOK_MAGIC, sizeof(header->magic)) != 0 ||
+           header->version != OPENING_BOOK_VERSION || header->entry_size != sizeof(Entry) ||
+           file_->getSize() != sizeof(OpeningBookHeader) + header->capacity * sizeof(Entry) ||
+           (header->capacity & (header->capacity - 1)) != 0)
+  {
+    throw file_error(file_name);
+  }
+
+  capacity_ = header->capacity;
+  entries_ = reinterpret_cast<Entry *>(static_cast<char *>(file_->getData()) + sizeof(OpeningBookHeader));
+  if (header->codebook_checksum != CardCodebook::getLoadedChecksum() || header->rules_version != GAME_RULES_VERSION)
+  {
+    if (!writable)
+      throw file_error(file_name);
+    std::memset(static_cast<void *>(entries_), 0, capacity_ * sizeof(Entry));
+    header->codebook_checksum = CardCodebook::getLoadedChecksum();
+    header->rules_version = GAME_RULES_VERSION;
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Writes the book back to the file and closes it
+///
+/// @return nothing
+OpeningBook::~OpeningBook()
+{
+  file_->sync();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Looks up the book action of a position
+///
+/// @param hash position hash
+/// @param action set to the stored action if the position was found
+///
+/// @return true = position found, false = position not in the book
+bool OpeningBook::lookup(uint64_t hash, Command &action) const
+{
+  for (uint64_t probe = 0; probe < OPENING_BOOK_MAX_PROBES; probe++)
+  {
+    const Entry &entry = entries_[(hash + probe) & (capacity_ - 1)];
+    if (entry.action[0] == '\0')
+    {
+      return false;
+    }
+    if (entry.hash == hash)
+    {
+      std::string text(entry.action, strnlen(entry.action, OPENING_BOOK_ACTION_LENGTH));
+      std::istringstream stream(text);
+      std::vector<std::string> words;
+      std::string word;
+      while (stream >> word)
+      {
+        words.push_back(word);
+      }
+      action = Command(words);
+      return true;
+    }
+  }
+  return false;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Stores the book action of a position, only possible for books opened as writable
+///
+/// @param hash position hash
+/// @param action action to play in that position
+///
+/// @return true = stored, false = action text too long or the probed part of the book is full
+bool OpeningBook::store(uint64_t hash, const Command &action)
+{
+  std::string text = action.toString();
+  if (text.empty() || text.size() > OPENING_BOOK_ACTION_LENGTH)
+  {
+    return false;
+  }
+
+  for (uint64_t probe = 0; probe < OPENING_BOOK_MAX_PROBES; probe++)
+  {
+    Entry &entry = entries_[(hash + probe) & (capacity_ - 1)];
+    if (entry.action[0] == '\0' || entry.hash == hash)
+    {
+      entry.hash = hash;
+      std::memset(entry.action, 0, OPENING_BOOK_ACTION_LENGTH);
+      std::memcpy(entry.action, text.data(), text.size());
+      return true;
+    }
+  }
+  return false;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Builds the book for the deck pairing of a game. The positions of the first OPENING_BOOK_ROUNDS rounds
+/// are visited breadth first, the line the bots would play first, and every position is searched by a
+/// bot of the player to move. Positions that are already in the book are kept and not searched again,
+/// but their children are, so building again with a larger budget adds the next positions. A position
+/// reached again by another order of actions is visited once, and at most OPENING_BOOK_FRONTIER_LIMIT
+/// positions wait to be visited.
+///
+/// @param game game that has not been started yet
+/// @param table table of solved positions shared by the bots, may be nullptr
+/// @param think_time think time per position
+/// @param max_positions maximum number of positions to search
+///
+/// @return number of positions that were added to the book
+unsigned long OpeningBook::build(const Game &game, std::shared_ptr<SolveTable> table,
+                                 std::chrono::milliseconds think_time, unsigned long max_positions)
+{
+  Bot bots[2] = {Bot(1, think_time, table), Bot(2, think_time, table)};
+
+  std::deque<Game> positions;
+  positions.emplace_back(game);
+  positions.back().setOutputStream(nullptr);
+  if (positions.back().startRound())
+    return 0;
+  std::unordered_set<uint64_t> visited{positions.back().positionHash()};
+
+  unsigned long added = 0;
+  while (!positions.empty() && added < max_positions)
+  {
+    Game &position = positions.front();
+    uint64_t hash = position.positionHash();
+    if (position.getRound() > OPENING_BOOK_ROUNDS)
+    {
+      positions.pop_front();
+      continue;
+    }
+
+    // a position of an earlier build keeps its action, but its children are visited again, so a
+    // larger budget continues where the last build stopped
+    Command action(CommandType::INVALID);
+    if (!lookup(hash, action))
+    {
+      action = bots[position.getActivePlayerNumber() - 1].chooseAction(position);
+      if (store(hash, action))
+        added++;
+    }
+
+    // the book action is expanded first, so the main line is covered before the alternatives
+    std::vector<Command> actions = position.generateActions();
+    std::stable_partition(actions.begin(), actions.end(),
+                          [&action](const Command &other) { return other.toString() == action.toString(); });
+    for (const Command &child_action : actions)
+    {
+      if (positions.size() > OPENING_BOOK_FRONTIER_LIMIT)
+        break;
+      positions.emplace_back(position);
+      positions.back().setOutputStream(nullptr);
+      if (positions.back().applyAction(child_action) || !visited.insert(positions.back().positionHash()).second)
+        positions.pop_back();
+    }
+    positions.pop_front();
+  }
+  return added;
+}
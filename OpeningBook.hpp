@@ -0,0 +1,55 @@
+#ifndef OPENINGBOOK_HPP
+#define OPENINGBOOK_HPP
+
+#include <string>
+#include <cstdint>
+#include <memory>
+#include <chrono>
+
+#include "Command.hpp"
+#include "MappedFile.hpp"
+#include "SolveTable.hpp"
+
+#define OPENING_BOOK_FILE "data/opening_book.bin"
+#define OPENING_BOOK_DEFAULT_CAPACITY (1ULL << 16)
+#define OPENING_BOOK_MAX_PROBES 32
+#define OPENING_BOOK_ROUNDS 2
+#define OPENING_BOOK_ACTION_LENGTH 24
+#define OPENING_BOOK_FRONTIER_LIMIT 4096
+
+class Game;
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Precomputed actions for the first rounds of a game, kept in a memory-mapped file keyed by position
+/// hash. The game has no random elements, so every opening position follows from the deck lines of the
+/// config and the actions played. Books of different deck pairings can share one file.
+///
+class OpeningBook
+{
+protected:
+  struct Entry
+  {
+    uint64_t hash;
+    char action[OPENING_BOOK_ACTION_LENGTH];
+  };
+
+  std::unique_ptr<MappedFile> file_;
+  Entry *entries_;
+  uint64_t capacity_;
+
+public:
+  // Forward declarations
+  OpeningBook(const std::string &file_name, bool writable, uint64_t capacity = OPENING_BOOK_DEFAULT_CAPACITY);
+  OpeningBook(const OpeningBook &) = delete;
+  ~OpeningBook();
+
+  bool lookup(uint64_t hash, Command &action) const;
+  bool store(uint64_t hash, const Command &action);
+  uint64_t getCapacity() const { return capacity_; }
+
+  unsigned long build(const Game &game, std::shared_ptr<SolveTable> table, std::chrono::milliseconds think_time,
+                      unsigned long max_positions);
+};
+
+#endif
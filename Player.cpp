@@ -9,6 +9,7 @@
 #include "Creature.hpp"
 #include "Player.hpp"
 #include "Init.hpp"
+#include "AllocationTracker.hpp"
 
 Player::Player(int number, int mana, int health, int mana_pool) : number_(number),
                                                                   mana_(mana), mana_pool_(mana_pool), health_(health), can_redraw_(true) {}
@@ -66,9 +67,12 @@ void Player::increaseManaPool()
 ///
 /// Prints the hand of the player
 ///
+/// @param out stream to print to
+///
 /// @return nothing
-void Player::printHand() const
+void Player::printHand(std::ostream &out) const
 {
+  AllocationScope scope(AllocationSubsystem::CARDS);
   if (hand_cards_.empty())
   {
     return;
@@ -78,13 +82,13 @@ void Player::printHand() const
   {
     for (unsigned long row = 0; row < 4; row++)
     {
-      std::cout << " ";
+      out << " ";
       for (unsigned long card_counter = 0 + card_row * 7; card_counter < card_row_size; card_counter++)
       {
-        std::cout << "   ";
-        std::cout << hand_cards_.at(card_counter)->printCard()[row];
+        out << "   ";
+        out << hand_cards_.at(card_counter)->printCard()[row];
       }
-      std::cout << std::endl;
+      out << std::endl;
     }
     card_row_size += 7;
     if (card_row_size > hand_cards_.size())
@@ -110,7 +114,7 @@ int Player::getHealth() const { return health_; }
 /// @return nothing
 void Player::drawInitialCards()
 {
-  for (int i = 0; i < 6; i++)
+  for (int i = 0; i < INITIAL_HAND_SIZE; i++)
   {
     hand_cards_.push_back(deck_.front());
     deck_.erase(deck_.begin());
@@ -205,7 +209,7 @@ void Player::setRedrawToFalse()
   can_redraw_ = false;
 }
 
-bool Player::getRedrawStatus()
+bool Player::getRedrawStatus() const
 {
   return can_redraw_;
 }
@@ -266,3 +270,59 @@ void Player::removeUndyingFromGraveyard(std::vector<unsigned long>& graveyard_in
     }
   }
 }
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Replaces every creature in the hand, deck and graveyard with its own copy, so a copied player can be
+/// changed without affecting the player it was copied from. Spells are never changed and stay shared.
+///
+/// @param arena arena the copies are created in, nullptr = heap
+///
+/// @return nothing
+void Player::detachCards(const std::shared_ptr<CardArena> &arena)
+{
+  AllocationScope scope(AllocationSubsystem::CARDS);
+  for (auto &card : hand_cards_)
+  {
+    std::shared_ptr<Creature> creature = std::dynamic_pointer_cast<Creature>(card);
+    if (creature)
+      card = allocateCard<Creature>(arena, *creature);
+  }
+  for (auto &card : deck_)
+  {
+    std::shared_ptr<Creature> creature = std::dynamic_pointer_cast<Creature>(card);
+    if (creature)
+      card = allocateCard<Creature>(arena, *creature);
+  }
+  for (auto &creature : graveyard_)
+  {
+    creature = allocateCard<Creature>(arena, *creature);
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Replaces the cards another player cannot see with a random arrangement of the same cards. The deck is
+/// shuffled; with include_hand the hand cards are shuffled together with the deck and the hand is dealt
+/// again with the same number of cards.
+///
+/// @param generator random number generator
+/// @param include_hand true = hand is hidden as well, false = only the deck order is hidden
+///
+/// @return nothing
+void Player::shuffleHiddenCards(std::mt19937_64 &generator, bool include_hand)
+{
+  if (!include_hand)
+  {
+    std::shuffle(deck_.begin(), deck_.end(), generator);
+    return;
+  }
+
+  unsigned long hand_size = hand_cards_.size();
+  std::vector<std::shared_ptr<Card>> hidden_cards = hand_cards_;
+  hidden_cards.insert(hidden_cards.end(), deck_.begin(), deck_.end());
+  std::shuffle(hidden_cards.begin(), hidden_cards.end(), generator);
+
+  hand_cards_.assign(hidden_cards.begin(), hidden_cards.begin() + hand_size);
+  deck_.assign(hidden_cards.begin() + hand_size, hidden_cards.end());
+}
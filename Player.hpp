@@ -5,10 +5,13 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <random>
 
 #include "Card.hpp"
 #include "Creature.hpp"
 
+#define INITIAL_HAND_SIZE 6
+
 class Player
 {
 protected:
@@ -42,7 +45,7 @@ public:
   int getHandSize() const;
 
   void increaseManaPool();
-  void printHand() const;
+  void printHand(std::ostream &out) const;
   void removeFromHand(std::string card_id);
   void removeFromGraveyard(std::string card_id);
   void removeUndyingFromGraveyard(std::vector<unsigned long> &graveyard_indexes);
@@ -64,7 +67,9 @@ public:
   const std::vector<std::shared_ptr<Card>> &getDeck() const { return deck_; }
 
   void setRedrawToFalse();
-  bool getRedrawStatus();
+  bool getRedrawStatus() const;
+  void detachCards(const std::shared_ptr<CardArena> &arena);
+  void shuffleHiddenCards(std::mt19937_64 &generator, bool include_hand);
 };
 
 #endif
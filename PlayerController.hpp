@@ -0,0 +1,32 @@
+#ifndef PLAYERCONTROLLER_HPP
+#define PLAYERCONTROLLER_HPP
+
+#include <chrono>
+
+#include "Command.hpp"
+
+class Game;
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Decides the actions of one player. The game loop starts a turn, waits for the action in short
+/// steps so it can react to the user in between, and applies the action to the game.
+///
+class PlayerController
+{
+public:
+  // Forward declarations
+  PlayerController() = default;
+  PlayerController(const PlayerController &) = delete;
+  virtual ~PlayerController() = default;
+
+  virtual void startTurn(const Game &game) = 0;
+  virtual bool waitForAction(std::chrono::milliseconds timeout) = 0;
+  virtual Command takeAction() = 0;
+  virtual void cancel() {}
+  virtual bool isHuman() const { return false; }
+  virtual void startPondering(const Game &) {}
+  virtual void stopPondering() {}
+};
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef PROTOTYPETABLE_HPP
+#define PROTOTYPETABLE_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Card prototypes of one kind, indexed by card ID. A table is built once when the card codebook is
+/// loaded and never changed afterwards, so looking up a card needs no lock. Loading the codebook again
+/// installs a new table for the cards created from then on; the old tables are kept, because existing
+/// cards still point to their prototypes.
+///
+template <typename Prototype>
+class PrototypeTable
+{
+protected:
+  std::vector<Prototype> prototypes_;
+  std::unordered_map<std::string_view, const Prototype *> index_;
+
+  static std::atomic<const PrototypeTable *> &current();
+
+public:
+  // Forward declarations
+  explicit PrototypeTable(std::vector<Prototype> prototypes);
+  PrototypeTable(const PrototypeTable &) = delete;
+  ~PrototypeTable() = default;
+
+  static const PrototypeTable *install(std::vector<Prototype> prototypes);
+  static const Prototype *lookup(std::string_view id);
+
+  const std::vector<Prototype> &getPrototypes() const { return prototypes_; }
+  const Prototype *find(std::string_view id) const;
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Builds the index of the prototypes, a card ID that appears twice refers to the last one
+///
+/// @param prototypes prototypes in codebook order
+///
+/// @return nothing
+template <typename Prototype>
+PrototypeTable<Prototype>::PrototypeTable(std::vector<Prototype> prototypes) : prototypes_(std::move(prototypes))
+{
+  index_.reserve(prototypes_.size());
+  for (const Prototype &prototype : prototypes_)
+    index_[prototype.id] = &prototype;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Table the cards are created from
+///
+/// @return pointer to the table, nullptr = no codebook loaded yet
+template <typename Prototype>
+std::atomic<const PrototypeTable<Prototype> *> &PrototypeTable<Prototype>::current()
+{
+  static std::atomic<const PrototypeTable *> table{nullptr};
+  return table;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Makes a new table the one the cards are created from. The table is kept for the rest of the program.
+///
+/// @param prototypes prototypes in codebook order
+///
+/// @return installed table
+template <typename Prototype>
+const PrototypeTable<Prototype> *PrototypeTable<Prototype>::install(std::vector<Prototype> prototypes)
+{
+  static std::vector<std::unique_ptr<const PrototypeTable>> tables;
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock(mutex);
+  tables.push_back(std::make_unique<const PrototypeTable>(std::move(prototypes)));
+  current().store(tables.back().get(), std::memory_order_release);
+  return tables.back().get();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Finds a prototype in the installed table
+///
+/// @param id card ID
+///
+/// @return prototype, nullptr = no card with this ID or no codebook loaded yet
+template <typename Prototype>
+const Prototype *PrototypeTable<Prototype>::lookup(std::string_view id)
+{
+  const PrototypeTable *table = current().load(std::memory_order_acquire);
+  return table ? table->find(id) : nullptr;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Finds a prototype of this table
+///
+/// @param id card ID
+///
+/// @return prototype, nullptr = no card with this ID
+template <typename Prototype>
+const Prototype *PrototypeTable<Prototype>::find(std::string_view id) const
+{
+  auto prototype = index_.find(id);
+  return prototype == index_.end() ? nullptr : prototype->second;
+}
+
+#endif
@@ -0,0 +1,200 @@
+#include <chrono>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ResultsLog.hpp"
+#include "Exeption.hpp"
+#include "Game.hpp"
+
+#define RESULTS_LOG_HEADER "config_id,seed,winner,end_reason,rounds,health_1,health_2\n"
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Opens the log for appending and starts the writer thread. A new log gets a header line. Throws a
+/// file_error if the file can not be opened.
+///
+/// @param file_name path to the log file
+///
+/// @return nothing
+ResultsLog::ResultsLog(const std::string &file_name)
+    : file_name_(file_name), file_descriptor_(-1), head_(nullptr), tail_(nullptr), closing_(false),
+      write_failed_(false)
+{
+  file_descriptor_ = open(file_name_.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (file_descriptor_ < 0)
+  {
+    throw file_error(file_name_);
+  }
+
+  struct stat file_status;
+  if (fstat(file_descriptor_, &file_status) == 0 && file_status.st_size == 0)
+  {
+    std::string header = RESULTS_LOG_HEADER;
+    if (writeFully(file_descriptor_, header) < header.size())
+    {
+      ::close(file_descriptor_);
+      throw file_error(file_name_);
+    }
+  }
+
+  // the queue always holds a stub node, the consumer owns everything behind it
+  Node *stub = new Node{ResultRecord{}, {nullptr}};
+  head_ = stub;
+  tail_ = stub;
+  writer_ = std::thread(&ResultsLog::writeRecords, this);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Writes all queued records, syncs the file and closes it
+///
+/// @return nothing
+ResultsLog::~ResultsLog()
+{
+  close();
+  delete tail_;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Writes all queued records, syncs the file and closes it. Records appended afterwards are not written.
+///
+/// @return true = every record was written, false = some records could not be written
+bool ResultsLog::close()
+{
+  if (writer_.joinable())
+  {
+    closing_ = true;
+    wake_.notify_one();
+    writer_.join();
+    ::close(file_descriptor_);
+  }
+  return !write_failed_;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Queues a record for writing, can be called from any thread
+///
+/// @param record result of one game
+///
+/// @return nothing
+void ResultsLog::append(const ResultRecord &record)
+{
+  Node *node = new Node{record, {nullptr}};
+  Node *previous = head_.exchange(node, std::memory_order_acq_rel);
+  previous->next.store(node, std::memory_order_release);
+  wake_.notify_one();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Takes the oldest record from the queue, only called by the writer thread
+///
+/// @param record set to the oldest record
+///
+/// @return true = record taken, false = queue is empty
+bool ResultsLog::pop(ResultRecord &record)
+{
+  Node *next = tail_->next.load(std::memory_order_acquire);
+  if (next == nullptr)
+    return false;
+  record = next->record;
+  delete tail_;
+  tail_ = next;
+  return true;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Writer thread: collects the queued records into one write and syncs the file in batches
+///
+/// @return nothing
+void ResultsLog::writeRecords()
+{
+  std::chrono::steady_clock::time_point last_sync = std::chrono::steady_clock::now();
+  unsigned long unsynced_records = 0;
+  std::string buffer;
+  while (true)
+  {
+    // read the flag first, so no record appended before closing is left behind
+    bool closing = closing_;
+    ResultRecord record;
+    while (pop(record))
+    {
+      buffer += formatRecord(record);
+      unsynced_records++;
+    }
+
+    if (!buffer.empty())
+    {
+      // a failed batch stays in the buffer and is written again with the next one
+      size_t written = writeFully(file_descriptor_, buffer);
+      buffer.erase(0, written);
+      if (!buffer.empty())
+        write_failed_ = true;
+    }
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (unsynced_records > 0 && (closing || unsynced_records >= RESULTS_LOG_SYNC_RECORDS ||
+                                 now - last_sync >= std::chrono::milliseconds(RESULTS_LOG_SYNC_INTERVAL_MS)))
+    {
+      fsync(file_descriptor_);
+      unsynced_records = 0;
+      last_sync = now;
+    }
+
+    if (closing)
+      return;
+
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    wake_.wait_for(lock, std::chrono::milliseconds(RESULTS_LOG_IDLE_WAIT_MS));
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Writes a buffer to a file, continuing after short writes and interrupted calls
+///
+/// @param file_descriptor file to write to
+/// @param buffer bytes to write
+///
+/// @return number of bytes written, less than the buffer size = write error
+size_t ResultsLog::writeFully(int file_descriptor, const std::string &buffer)
+{
+  size_t written = 0;
+  while (written < buffer.size())
+  {
+    ssize_t result = write(file_descriptor, buffer.data() + written, buffer.size() - written);
+    if (result < 0 && errno == EINTR)
+      continue;
+    if (result <= 0)
+      break;
+    written += static_cast<size_t>(result);
+  }
+  return written;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Formats a record as one CSV line
+///
+/// @param record result of one game
+///
+/// @return CSV line including the line break
+std::string ResultsLog::formatRecord(const ResultRecord &record)
+{
+  int winner = Game::winnerFromStatus(record.game_status);
+
+  std::string end_reason = "max_rounds";
+  if (record.game_status == 1 || record.game_status == 2)
+    end_reason = "empty_deck";
+  else if (record.game_status == 3 || record.game_status == 4 || record.game_status == 7)
+    end_reason = "defeat";
+
+  return std::to_string(record.config_id) + "," + std::to_string(record.seed) + "," + std::to_string(winner) +
+         "," + end_reason + "," + std::to_string(record.rounds) + "," + std::to_string(record.health[0]) + "," +
+         std::to_string(record.health[1]) + "\n";
+}
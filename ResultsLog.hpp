@@ -0,0 +1,68 @@
+#ifndef RESULTSLOG_HPP
+#define RESULTSLOG_HPP
+
+#include <string>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+#define RESULTS_LOG_FILE "data/results.csv"
+#define RESULTS_LOG_SYNC_RECORDS 256
+#define RESULTS_LOG_SYNC_INTERVAL_MS 1000
+#define RESULTS_LOG_IDLE_WAIT_MS 100
+
+struct ResultRecord
+{
+  uint32_t config_id;
+  uint64_t seed;
+  int game_status;
+  int rounds;
+  int health[2];
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Append-only CSV log of game results. Any thread can append records without locking; they go through
+/// a lock-free queue to a single writer thread, which writes them in batches and syncs the file after
+/// every RESULTS_LOG_SYNC_RECORDS records or RESULTS_LOG_SYNC_INTERVAL_MS milliseconds. Records that
+/// could not be written are kept and written again with the next batch.
+///
+class ResultsLog
+{
+protected:
+  struct Node
+  {
+    ResultRecord record;
+    std::atomic<Node *> next;
+  };
+
+  std::string file_name_;
+  int file_descriptor_;
+  std::atomic<Node *> head_;
+  Node *tail_;
+  std::atomic<bool> closing_;
+  std::atomic<bool> write_failed_;
+  std::mutex wake_mutex_;
+  std::condition_variable wake_;
+  std::thread writer_;
+
+  bool pop(ResultRecord &record);
+  void writeRecords();
+  static size_t writeFully(int file_descriptor, const std::string &buffer);
+
+public:
+  // Forward declarations
+  explicit ResultsLog(const std::string &file_name);
+  ResultsLog(const ResultsLog &) = delete;
+  ~ResultsLog();
+
+  void append(const ResultRecord &record);
+  bool close();
+  const std::string &getFileName() const { return file_name_; }
+
+  static std::string formatRecord(const ResultRecord &record);
+};
+
+#endif
@@ -0,0 +1,172 @@
+#include "Simulator.hpp"
+#include "Init.hpp"
+#include "Game.hpp"
+#include "Bot.hpp"
+#include "JobScheduler.hpp"
+#include <thread>
+#include <algorithm>
+
+Simulator::Simulator(const ConfigCorpus &corpus, const Init &init, std::chrono::milliseconds think_time,
+                     std::shared_ptr<SolveTable> table, ResultsLog *log, uint64_t seed, EventLog *events,
+                     AllocationReport *allocations)
+    : corpus_(corpus), errors_(init.getErrors()), infos_(init.getInfos()), descriptions_(init.getDescriptions()),
+      creature_codebook_(init.getCreatureCodebook()), spell_codebook_(init.getSpellCodebook()),
+      think_time_(think_time), table_(table), log_(log), events_(events), allocations_(allocations), seed_(seed),
+      thread_count_(1), progress_(nullptr) {}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Plays one match to the end
+///
+/// @param match config of the match
+/// @param allocations gets the allocations of the match, nullptr = allocations are not reported
+/// @param counters gets the counters of the match, nullptr = not counted
+///
+/// @return result of the match
+ResultRecord Simulator::playMatch(const MatchSpec &match, AllocationReport *allocations,
+                                  MatchCounters *counters) const
+{
+  AllocationSnapshot allocations_before;
+  if (allocations)
+  {
+    allocations_before = AllocationTracker::totals();
+    AllocationTracker::resetPeak();
+  }
+
+  // declared first, so it outlives the creatures of both players
+  std::shared_ptr<CardArena> arena = std::make_shared<CardArena>();
+  Player player1(1, 0, 0, 0);
+  Player player2(2, 0, 0, 0);
+  corpus_.createPlayers(match, player1, player2, arena);
+
+  Game game{player1, player2, errors_, infos_, descriptions_, match.max_rounds, creature_codebook_,
+            spell_codebook_, nullptr, arena};
+  if (events_)
+    game.setEventStream(events_->openGame(match.config_id));
+  game.setAllocationReport(allocations);
+  game.setMatchCounters(counters);
+  uint64_t seed = seed_ + match.config_id;
+  Bot bots[2] = {Bot(1, think_time_, table_, seed), Bot(2, think_time_, table_, seed ^ 0x9e3779b97f4a7c15ULL)};
+
+  int game_status = game.startRound();
+  while (!game_status)
+  {
+    game_status = game.applyAction(bots[game.getActivePlayerNumber() - 1].chooseAction(game));
+  }
+  if (allocations)
+    allocations->finishGame(AllocationTracker::totals() - allocations_before, AllocationTracker::getPeakBytes());
+
+  return {match.config_id, seed, game_status, game.getRound(),
+          {game.getPlayer(1).getHealth(), game.getPlayer(2).getHealth()}};
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Simulation slot: plays the next match that no other slot has taken until all are played
+///
+/// @param results results of all matches in corpus order
+/// @param allocations allocations of all matches in corpus order, empty = not reported
+/// @param statistics statistics of this slot
+/// @param progress progress slot of this slot
+/// @param next_match index of the next match to play, shared by all slots
+///
+/// @return nothing
+void Simulator::playMatches(std::vector<ResultRecord> &results, std::vector<AllocationReport> &allocations,
+                            StatisticsAccumulator &statistics, ProgressSlot &progress,
+                            std::atomic<unsigned long> &next_match) const
+{
+  const std::vector<MatchSpec> &matches = corpus_.getMatches();
+  for (unsigned long index = next_match.fetch_add(1); index < matches.size(); index = next_match.fetch_add(1))
+  {
+    MatchCounters counters;
+    results[index] = playMatch(matches[index], allocations.empty() ? nullptr : &allocations[index], &counters);
+    if (log_)
+      log_->append(results[index]);
+
+    std::string decks[2] = {corpus_.getDeckText(matches[index], 1), corpus_.getDeckText(matches[index], 2)};
+    statistics.addMatch(results[index], counters, decks);
+    progress.publish(statistics);
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Plays all matches of the corpus as jobs of the simulation slots, the bots use all cores for every action.
+/// With an allocation report the matches are played one after another, so the allocations of a match
+/// are not mixed up with the others.
+///
+/// @param out stream for one line per match, a summary and the statistics at the end
+///
+/// @return results in corpus order, they are also appended to the results log
+std::vector<ResultRecord> Simulator::run(std::ostream &out) const
+{
+  const std::vector<MatchSpec> &matches = corpus_.getMatches();
+  unsigned long slot_count = allocations_ ? 1 : std::min<unsigned long>(thread_count_, matches.size());
+  slot_count = std::max(slot_count, 1UL);
+
+  std::vector<ResultRecord> results(matches.size());
+  std::vector<AllocationReport> match_allocations(allocations_ ? matches.size() : 0);
+  std::vector<StatisticsAccumulator> statistics(slot_count);
+  std::vector<ProgressSlot> progress(slot_count);
+  std::atomic<unsigned long> next_match{0};
+
+  // the simulation slots get a scheduler of their own, so the searches of the bots on the shared one
+  // never run a whole match while they wait for their samplers
+  JobScheduler scheduler(slot_count);
+  JobGroup slots(scheduler);
+  for (unsigned long slot = 0; slot < slot_count; slot++)
+  {
+    slots.run([this, &results, &match_allocations, &statistics, &progress, &next_match, slot]
+              { playMatches(results, match_allocations, statistics[slot], progress[slot], next_match); });
+  }
+
+  // live view of the published progress, the simulation slots never wait for it
+  while (true)
+  {
+    bool finished = slots.isFinished();
+    ProgressSnapshot total;
+    for (const ProgressSlot &slot : progress)
+      total += slot.read();
+    if (progress_)
+    {
+      *progress_ << "\rProgress: " << total.matches << "/" << matches.size() << " matches, Player 1 wins: "
+                 << total.wins[1] << ", Player 2 wins: " << total.wins[2] << ", ties: " << total.wins[0]
+                 << ", average rounds: " << (total.matches ? static_cast<double>(total.rounds) / total.matches : 0.0)
+                 << std::flush;
+    }
+    if (finished)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(SIMULATOR_PROGRESS_INTERVAL_MS));
+  }
+  if (progress_)
+    *progress_ << std::endl;
+  slots.wait();
+
+  StatisticsAccumulator totals;
+  for (const StatisticsAccumulator &slot_statistics : statistics)
+    totals.merge(slot_statistics);
+
+  for (unsigned long index = 0; index < results.size(); index++)
+  {
+    const ResultRecord &result = results[index];
+    int winner = Game::winnerFromStatus(result.game_status);
+    out << "Config " << result.config_id << ": " << (winner ? "Player " + std::to_string(winner) + " wins" : "Tie")
+        << " after " << result.rounds << " rounds, health " << result.health[0] << ":" << result.health[1]
+        << std::endl;
+    if (allocations_)
+    {
+      AllocationCounts total = match_allocations[index].getTotal();
+      out << "  " << total.count << " allocations, " << total.bytes << " bytes, heap high-water "
+          << match_allocations[index].getPeakBytes() << " bytes" << std::endl;
+      allocations_->merge(match_allocations[index]);
+    }
+  }
+
+  out << "Matches: " << results.size() << ", Player 1 wins: " << totals.getWins(1) << ", Player 2 wins: "
+      << totals.getWins(2) << ", ties: " << totals.getWins(0) << ", skipped configs: " << corpus_.getErrors().size()
+      << std::endl;
+  if (allocations_)
+    allocations_->print(out);
+  totals.print(out);
+  return results;
+}
@@ -0,0 +1,73 @@
+#ifndef SIMULATOR_HPP
+#define SIMULATOR_HPP
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include <atomic>
+
+#include "ConfigCorpus.hpp"
+#include "Creature.hpp"
+#include "Spell.hpp"
+#include "SolveTable.hpp"
+#include "ResultsLog.hpp"
+#include "EventLog.hpp"
+#include "AllocationTracker.hpp"
+#include "BatchStatistics.hpp"
+
+#define SIMULATOR_PROGRESS_INTERVAL_MS 200
+
+class Init;
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Plays the matches of a corpus without output, both players are bots. The bots of a match are seeded
+/// from the seed of the run and the config ID, the seed is logged with the result. With an event log,
+/// the events of every match are logged under its config ID. With an allocation report, the
+/// allocations of every match are printed and rolled up into the report.
+///
+/// Matches can be played by several simulation slots at once, each one a job of a scheduler of the batch.
+/// Every slot adds its matches to its own statistics and publishes its progress for the live view
+/// without waiting; the statistics are merged and printed when all matches have been played.
+///
+class Simulator
+{
+protected:
+  const ConfigCorpus &corpus_;
+  std::map<std::string, std::string> errors_;
+  std::map<std::string, std::string> infos_;
+  std::map<std::string, std::string> descriptions_;
+  std::vector<std::shared_ptr<Creature>> creature_codebook_;
+  std::vector<std::shared_ptr<Spell>> spell_codebook_;
+  std::chrono::milliseconds think_time_;
+  std::shared_ptr<SolveTable> table_;
+  ResultsLog *log_;
+  EventLog *events_;
+  AllocationReport *allocations_;
+  uint64_t seed_;
+  unsigned int thread_count_;
+  std::ostream *progress_;
+
+  void playMatches(std::vector<ResultRecord> &results, std::vector<AllocationReport> &allocations,
+                   StatisticsAccumulator &statistics, ProgressSlot &progress,
+                   std::atomic<unsigned long> &next_match) const;
+
+public:
+  // Forward declarations
+  Simulator(const ConfigCorpus &corpus, const Init &init, std::chrono::milliseconds think_time,
+            std::shared_ptr<SolveTable> table, ResultsLog *log, uint64_t seed, EventLog *events = nullptr,
+            AllocationReport *allocations = nullptr);
+  Simulator(const Simulator &) = delete;
+  ~Simulator() = default;
+
+  void setThreadCount(unsigned int thread_count) { thread_count_ = thread_count; }
+  void setProgressStream(std::ostream *progress) { progress_ = progress; }
+  ResultRecord playMatch(const MatchSpec &match, AllocationReport *allocations = nullptr,
+                         MatchCounters *counters = nullptr) const;
+  std::vector<ResultRecord> run(std::ostream &out) const;
+};
+
+#endif
@@ -0,0 +1,126 @@
+#include <cstring>
+
+#include "SolveTable.hpp"
+#include "Exeption.hpp"
+#include "CardCodebook.hpp"
+
+#define SOLVE_TABLE_MAGIC "MOOPSOLV"
+#define SOLVE_TABLE_VERSION 2
+
+struct SolveTableHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t entry_size;
+  uint64_t capacity;
+  uint64_t codebook_checksum;
+  uint32_t rules_version;
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Opens the table file, creates an empty table if the file does not exist yet. The outcomes of a table
+/// that was solved with another codebook or other rules are discarded.
+///
+/// @param file_name path to the table file
+/// @param capacity number of entries of a newly created table, has to be a power of two
+///
+/// @return nothing
+SolveTable::SolveTable(const std::string &file_name, uint64_t capacity) : entries_(nullptr), capacity_(capacity)
+{
+  file_ = std::make_unique<MappedFile>(file_name, true, sizeof(SolveTableHeader) + capacity_ * sizeof(uint64_t));
+
+  SolveTableHeader *header = static_cast<SolveTableHeader *>(file_->getData());
+  if (file_->wasCreated())
+  {
+    std::memcpy(header->magic, SOLVE_TABLE_MAGIC, sizeof(header->magic));
+    header->version = SOLVE_TABLE_VERSION;
+    header->entry_size = sizeof(uint64_t);
+    header->capacity = capacity_;
+    header->codebook_checksum = CardCodebook::getLoadedChecksum();
+    header->rules_version = GAME_RULES_VERSION;
+  }
+  else if (file_->getSize() < sizeof(SolveTableHeader) ||
+           std::memcmp(header->magic, SOLVE_TABLE_MAGIC, sizeof(header->magic)) != 0 ||
+           header->version != SOLVE_TABLE_VERSION || header->entry_size != sizeof(uint64_t) ||
+           file_->getSize() != sizeof(SolveTableHeader) + header->capacity * sizeof(uint64_t) ||
+           (header->capacity & (header->capacity - 1)) != 0)
+  {
+    throw file_error(file_name);
+  }
+
+  capacity_ = header->capacity;
+  entries_ = reinterpret_cast<uint64_t *>(static_cast<char *>(file_->getData()) + sizeof(SolveTableHeader));
+  if (header->codebook_checksum != CardCodebook::getLoadedChecksum() || header->rules_version != GAME_RULES_VERSION)
+  {
+    std::memset(entries_, 0, capacity_ * sizeof(uint64_t));
+    header->codebook_checksum = CardCodebook::getLoadedChecksum();
+    header->rules_version = GAME_RULES_VERSION;
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Writes the table back to the file and closes it
+///
+/// @return nothing
+SolveTable::~SolveTable()
+{
+  file_->sync();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Looks up a solved position
+///
+/// @param hash position hash
+/// @param outcome set to the stored outcome if the position was found
+///
+/// @return true = position found, false = position not solved yet
+bool SolveTable::lookup(uint64_t hash, Outcome &outcome)
+{
+  uint64_t key = hash & ~3ULL;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (uint64_t probe = 0; probe < SOLVE_TABLE_MAX_PROBES; probe++)
+  {
+    uint64_t entry = entries_[((hash >> 2) + probe) & (capacity_ - 1)];
+    if (entry == 0)
+    {
+      return false;
+    }
+    if ((entry & ~3ULL) == key)
+    {
+      outcome = static_cast<Outcome>(entry & 3ULL);
+      return true;
+    }
+  }
+  return false;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Stores a solved position, nothing is stored if the probed part of the table is full
+///
+/// @param hash position hash
+/// @param outcome outcome of the position, Outcome::UNKNOWN is never stored
+///
+/// @return nothing
+void SolveTable::store(uint64_t hash, Outcome outcome)
+{
+  if (outcome == Outcome::UNKNOWN)
+  {
+    return;
+  }
+
+  uint64_t key = hash & ~3ULL;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (uint64_t probe = 0; probe < SOLVE_TABLE_MAX_PROBES; probe++)
+  {
+    uint64_t &entry = entries_[((hash >> 2) + probe) & (capacity_ - 1)];
+    if (entry == 0 || (entry & ~3ULL) == key)
+    {
+      entry = key | static_cast<uint64_t>(outcome);
+      return;
+    }
+  }
+}
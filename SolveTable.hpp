@@ -0,0 +1,48 @@
+#ifndef SOLVETABLE_HPP
+#define SOLVETABLE_HPP
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <memory>
+
+#include "MappedFile.hpp"
+
+#define SOLVE_TABLE_FILE "data/endgame_table.bin"
+#define SOLVE_TABLE_DEFAULT_CAPACITY (1ULL << 20)
+#define SOLVE_TABLE_MAX_PROBES 32
+
+enum class Outcome
+{
+  UNKNOWN = 0,
+  PLAYER1_WINS = 1,
+  PLAYER2_WINS = 2,
+  DRAW = 3
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Hash table of solved positions, kept in a memory-mapped file so it survives between sessions.
+/// Every entry is one 64 bit word: the upper 62 bits of the position hash and the 2 bit outcome.
+///
+class SolveTable
+{
+protected:
+  std::unique_ptr<MappedFile> file_;
+  uint64_t *entries_;
+  uint64_t capacity_;
+  std::mutex mutex_;
+
+public:
+  // Forward declarations
+  explicit SolveTable(const std::string &file_name, uint64_t capacity = SOLVE_TABLE_DEFAULT_CAPACITY);
+  SolveTable(const SolveTable &) = delete;
+  ~SolveTable();
+
+  bool lookup(uint64_t hash, Outcome &outcome);
+  void store(uint64_t hash, Outcome outcome);
+  uint64_t getCapacity() const { return capacity_; }
+};
+
+#endif
@@ -0,0 +1,238 @@
+#include <algorithm>
+
+#include "Solver.hpp"
+#include "Game.hpp"
+
+Solver::Solver(SolveTable *table, unsigned long node_limit)
+    : table_(table), node_limit_(node_limit), nodes_(0), table_hits_(0), aborted_(false), has_deadline_(false),
+      cancel_flag_(nullptr) {}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Sets a point in time after which every search is aborted with an unknown outcome
+///
+/// @param deadline time limit of the search
+///
+/// @return nothing
+void Solver::setDeadline(std::chrono::steady_clock::time_point deadline)
+{
+  has_deadline_ = true;
+  deadline_ = deadline;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Checks whether searching has to stop, because the deadline is reached or the search was cancelled
+///
+/// @return true = deadline reached or cancel flag set, false = search can continue
+bool Solver::wasInterrupted() const
+{
+  if (cancel_flag_ && cancel_flag_->load(std::memory_order_relaxed))
+    return true;
+  return has_deadline_ && std::chrono::steady_clock::now() >= deadline_;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Counts a searched position and checks whether the node limit or the deadline is reached, or the
+/// search was cancelled
+///
+/// @return true = search has to be aborted, false = search can continue
+bool Solver::isOutOfBudget()
+{
+  if (++nodes_ > node_limit_)
+    return true;
+  return (nodes_ & 255) == 0 && wasInterrupted();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Solves a position
+///
+/// @param game position to solve, it is not changed
+///
+/// @return outcome under perfect play, the action leading to it and search statistics.
+///         Outcome::UNKNOWN if the node limit was reached before the position was solved.
+SolverResult Solver::solve(const Game &game)
+{
+  nodes_ = 0;
+  table_hits_ = 0;
+  aborted_ = false;
+  if (memo_.size() > SOLVER_MEMO_LIMIT)
+    memo_.clear();
+
+  Command best_action(CommandType::DONE);
+  int value = search(game, -1, 1, &best_action);
+
+  SolverResult result{aborted_ ? Outcome::UNKNOWN : outcomeFromValue(value), best_action, nodes_, table_hits_};
+  return result;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Solves the position after every legal action of the active player. Every action gets the full node
+/// limit of the solver.
+///
+/// @param game position to evaluate, it is not changed
+///
+/// @return every legal action with its outcome under perfect play, Outcome::UNKNOWN if the action
+///         could not be solved within the node limit or before the deadline
+std::vector<ActionValue> Solver::evaluateActions(const Game &game)
+{
+  std::vector<ActionValue> values;
+  table_hits_ = 0;
+  if (memo_.size() > SOLVER_MEMO_LIMIT)
+    memo_.clear();
+
+  for (const Command &action : game.generateActions())
+  {
+    nodes_ = 0;
+    aborted_ = false;
+
+    Game child(game);
+    child.setOutputStream(nullptr);
+    int game_status = child.applyAction(action);
+
+    Outcome outcome = outcomeFromStatus(game_status);
+    if (!game_status)
+    {
+      int value = search(child, -1, 1, nullptr);
+      outcome = aborted_ ? Outcome::UNKNOWN : outcomeFromValue(value);
+    }
+    values.push_back({action, outcome});
+
+    if (wasInterrupted())
+      break;
+  }
+  return values;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Searches a position. Values are seen from player 1: 1 = player 1 wins, 0 = tie, -1 = player 2 wins.
+///
+/// @param game position to search
+/// @param alpha value player 1 can already force
+/// @param beta value player 2 can already force
+/// @param best_action set to the best action if not nullptr, only used for the root position
+///
+/// @return value of the position, a bound if it lies outside of alpha and beta
+int Solver::search(const Game &game, int alpha, int beta, Command *best_action)
+{
+  uint64_t hash = game.positionHash();
+  Bounds bounds{-1, 1};
+
+  auto memo_entry = memo_.find(hash);
+  if (memo_entry != memo_.end())
+  {
+    bounds = memo_entry->second;
+  }
+  else if (table_ != nullptr)
+  {
+    Outcome outcome;
+    if (table_->lookup(hash, outcome))
+    {
+      table_hits_++;
+      int value = valueFromOutcome(outcome);
+      bounds = {value, value};
+      memo_[hash] = bounds;
+    }
+  }
+
+  if (best_action == nullptr)
+  {
+    if (bounds.lower == bounds.upper || bounds.lower >= beta)
+      return bounds.lower;
+    if (bounds.upper <= alpha)
+      return bounds.upper;
+    alpha = std::max(alpha, bounds.lower);
+    beta = std::min(beta, bounds.upper);
+  }
+
+  if (isOutOfBudget())
+  {
+    aborted_ = true;
+    return 0;
+  }
+
+  bool maximizing = game.getActivePlayerNumber() == 1;
+  int original_alpha = alpha;
+  int original_beta = beta;
+  int best = maximizing ? -2 : 2;
+
+  for (const Command &action : game.generateActions())
+  {
+    Game child(game);
+    child.setOutputStream(nullptr);
+    int game_status = child.applyAction(action);
+    if (!game_status && child.positionHash() == hash)
+      continue;
+
+    int value = game_status ? valueFromOutcome(outcomeFromStatus(game_status)) : search(child, alpha, beta, nullptr);
+    if (aborted_)
+      return 0;
+
+    if (maximizing ? value > best : value < best)
+    {
+      best = value;
+      if (best_action != nullptr)
+        *best_action = action;
+    }
+    if (maximizing)
+      alpha = std::max(alpha, value);
+    else
+      beta = std::min(beta, value);
+    if (alpha >= beta)
+      break;
+  }
+
+  if (best <= original_alpha)
+    bounds.upper = std::min(bounds.upper, best);
+  else if (best >= original_beta)
+    bounds.lower = std::max(bounds.lower, best);
+  else
+    bounds = {best, best};
+  memo_[hash] = bounds;
+
+  if (table_ != nullptr && bounds.lower == bounds.upper)
+  {
+    table_->store(hash, outcomeFromValue(bounds.lower));
+  }
+  return best;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Converts a game status into an outcome
+///
+/// @param game_status game status as returned by Game::startRound()
+///
+/// @return outcome of the game, Outcome::UNKNOWN if the game continues
+Outcome Solver::outcomeFromStatus(int game_status)
+{
+  if (game_status == 1 || game_status == 3 || game_status == 5)
+    return Outcome::PLAYER1_WINS;
+  if (game_status == 2 || game_status == 4 || game_status == 6)
+    return Outcome::PLAYER2_WINS;
+  if (game_status == 7 || game_status == 8)
+    return Outcome::DRAW;
+  return Outcome::UNKNOWN;
+}
+
+int Solver::valueFromOutcome(Outcome outcome)
+{
+  if (outcome == Outcome::PLAYER1_WINS)
+    return 1;
+  if (outcome == Outcome::PLAYER2_WINS)
+    return -1;
+  return 0;
+}
+
+Outcome Solver::outcomeFromValue(int value)
+{
+  if (value > 0)
+    return Outcome::PLAYER1_WINS;
+  if (value < 0)
+    return Outcome::PLAYER2_WINS;
+  return Outcome::DRAW;
+}
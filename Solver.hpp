@@ -0,0 +1,75 @@
+#ifndef SOLVER_HPP
+#define SOLVER_HPP
+
+#include <unordered_map>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+
+#include "Command.hpp"
+#include "SolveTable.hpp"
+
+#define SOLVER_MEMO_LIMIT (1UL << 20)
+
+class Game;
+
+struct SolverResult
+{
+  Outcome outcome;
+  Command best_action;
+  unsigned long nodes;
+  unsigned long table_hits;
+};
+
+struct ActionValue
+{
+  Command action;
+  Outcome outcome;
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Perfect play solver. Searches a position depth first to the end of the game with alpha-beta
+/// pruning and remembers every position it has already solved.
+///
+class Solver
+{
+protected:
+  struct Bounds
+  {
+    int lower;
+    int upper;
+  };
+
+  SolveTable *table_;
+  unsigned long node_limit_;
+  unsigned long nodes_;
+  unsigned long table_hits_;
+  bool aborted_;
+  bool has_deadline_;
+  std::chrono::steady_clock::time_point deadline_;
+  const std::atomic<bool> *cancel_flag_;
+  std::unordered_map<uint64_t, Bounds> memo_;
+
+  int search(const Game &game, int alpha, int beta, Command *best_action);
+  bool isOutOfBudget();
+
+public:
+  // Forward declarations
+  Solver(SolveTable *table, unsigned long node_limit);
+  Solver(const Solver &) = delete;
+  ~Solver() = default;
+
+  SolverResult solve(const Game &game);
+  std::vector<ActionValue> evaluateActions(const Game &game);
+  void setDeadline(std::chrono::steady_clock::time_point deadline);
+  void setCancelFlag(const std::atomic<bool> *cancel_flag) { cancel_flag_ = cancel_flag; }
+  bool wasInterrupted() const;
+
+  static Outcome outcomeFromStatus(int game_status);
+  static int valueFromOutcome(Outcome outcome);
+  static Outcome outcomeFromValue(int value);
+};
+
+#endif
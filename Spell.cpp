@@ -1,12 +1,302 @@
 #include <iostream>
 #include <algorithm>
+#include <charconv>
+#include <stdexcept>
 
 #include "Spell.hpp"
+#include "AllocationTracker.hpp"
+#include "PrototypeTable.hpp"
 
-Spell::Spell(std::string name, std::string ID, int mana_cost, std::string effect)
-    : Card(name, ID), mana_cost_(mana_cost), effect_(effect)
+#define SPELL_XX_MANA_TEXT "x"
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// State of a spell while its program runs
+///
+struct SpellContext
+{
+  Player &player;
+  Player &opponent;
+  Board &board;
+  std::shared_ptr<Creature> &target;
+  int round;
+  const std::shared_ptr<CardArena> &arena;
+  Creature *selection[SPELL_SELECTION_SIZE];
+  int selected;
+  std::shared_ptr<Creature> created;
+};
+
+typedef void (*SpellHandler)(SpellContext &context, int argument);
+
+static void selectSide(SpellContext &context, int player)
+{
+  for (int slot = 0; slot < 7; slot++)
+  {
+    if (Creature *creature = context.board.fetchFieldCard(player, slot))
+      context.selection[context.selected++] = creature;
+    if (Creature *creature = context.board.fetchBattleCard(player, slot))
+      context.selection[context.selected++] = creature;
+  }
+}
+
+static void selectOwn(SpellContext &context, int)
+{
+  context.selected = 0;
+  selectSide(context, context.player.getPlayerNumber());
+}
+
+static void selectEnemy(SpellContext &context, int)
+{
+  context.selected = 0;
+  selectSide(context, context.opponent.getPlayerNumber());
+}
+
+static void selectAll(SpellContext &context, int)
+{
+  context.selected = 0;
+  selectSide(context, 1);
+  selectSide(context, 2);
+}
+
+static void damage(SpellContext &context, int argument)
+{
+  for (int index = 0; index < context.selected; index++)
+    context.board.damageCreature(context.selection[index], argument);
+}
+
+static void addAttack(SpellContext &context, int argument)
+{
+  for (int index = 0; index < context.selected; index++)
+    context.selection[index]->increaseCurrentAttack(argument);
+}
+
+static void addHealth(SpellContext &context, int argument)
+{
+  for (int index = 0; index < context.selected; index++)
+    context.board.setCreatureHealth(context.selection[index], context.selection[index]->getCurrentHealth() + argument);
+}
+
+static void addTrait(SpellContext &context, int argument)
+{
+  for (int index = 0; index < context.selected; index++)
+    context.selection[index]->addTrait(static_cast<Trait>(argument));
+}
+
+static void removeTrait(SpellContext &context, int)
+{
+  for (int index = 0; index < context.selected; index++)
+    context.selection[index]->removeTrait();
+}
+
+// the health is divided rounded up, so a creature never dies of it
+static void divideHealth(SpellContext &context, int argument)
+{
+  for (int index = 0; index < context.selected; index++)
+  {
+    Creature *creature = context.selection[index];
+    context.board.setCreatureHealth(creature, (creature->getCurrentHealth() + argument - 1) / argument);
+  }
+}
+
+static void cloneTarget(SpellContext &context, int)
+{
+  context.created =
+      std::dynamic_pointer_cast<Creature>(Card::createCardFromID(context.target->getCardID(), context.arena));
+  context.created->setCurrentAttack(context.target->getCurrentAttack());
+  context.board.setCreatureHealth(context.created.get(), context.target->getCurrentHealth());
+  context.created->setTraitMask(context.target->getTraitMask());
+  context.created->setRoundPlacement(context.round);
+  context.board.placeCard(context.created, context.player.getPlayerNumber(), -1);
+  context.selection[0] = context.created.get();
+  context.selected = 1;
+}
+
+// a full field leaves the creature in the graveyard and selects nothing
+static void returnToField(SpellContext &context, int)
+{
+  context.selected = 0;
+  if (context.board.areAllFieldsFull(context.player.getPlayerNumber()))
+    return;
+  context.player.removeFromGraveyard(context.target->getCardID());
+  context.target->resetAttributes();
+  context.target->setRoundPlacement(context.round);
+  context.board.placeCard(context.target, context.player.getPlayerNumber(), -1);
+  context.selection[0] = context.target.get();
+  context.selected = 1;
+}
+
+static void returnToHand(SpellContext &context, int)
+{
+  context.selected = 0;
+  context.player.removeFromGraveyard(context.target->getCardID());
+  context.target->resetAttributes();
+  context.player.addCardToHand(context.target);
+}
+
+// indexed by SpellOpcode
+static const SpellHandler SPELL_HANDLERS[] = {selectOwn,   selectEnemy, selectAll,    damage,
+                                              addAttack,   addHealth,   addTrait,     removeTrait,
+                                              divideHealth, cloneTarget, returnToField, returnToHand};
+static const char *const SPELL_OPCODE_NAMES[] = {"own",    "enemy",  "all",   "damage",
+                                                 "attack", "health", "trait", "remove_trait",
+                                                 "divide_health", "clone", "to_field", "to_hand"};
+static const bool SPELL_OPCODE_ARGUMENTS[] = {false, false, false, true,
+                                              true,  true,  true,  false,
+                                              true,  false, false, false};
+static_assert(sizeof(SPELL_HANDLERS) / sizeof(SPELL_HANDLERS[0]) == static_cast<size_t>(SpellOpcode::COUNT) &&
+                  sizeof(SPELL_OPCODE_NAMES) / sizeof(SPELL_OPCODE_NAMES[0]) ==
+                      static_cast<size_t>(SpellOpcode::COUNT) &&
+                  sizeof(SPELL_OPCODE_ARGUMENTS) / sizeof(SPELL_OPCODE_ARGUMENTS[0]) ==
+                      static_cast<size_t>(SpellOpcode::COUNT),
+              "every spell opcode needs a handler, a name and an argument flag");
+
+Spell::Spell(const SpellPrototype *prototype) : prototype_(prototype) {}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Finds the prototype of a spell. The spells are defined by the card codebook, which is loaded before
+/// the decks, so no spell exists before its prototype.
+///
+/// @param ID card ID
+///
+/// @return prototype, nullptr = no spell with this ID
+const SpellPrototype *Spell::findPrototype(const std::string &ID)
+{
+  return PrototypeTable<SpellPrototype>::lookup(ID);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Parses a number field of the codebook. Throws std::invalid_argument unless the whole field is a number.
+///
+/// @param text field
+///
+/// @return number
+static int parseNumber(std::string_view text)
+{
+  int value = 0;
+  const char *end = text.data() + text.size();
+  auto result = std::from_chars(text.data(), end, value);
+  if (text.empty() || result.ec != std::errc() || result.ptr != end)
+    throw std::invalid_argument(std::string(text));
+  return value;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Parses the mana cost field of the codebook: a number, "x/2" = half the target's cost rounded up or
+/// "x+1" = the target's cost plus 1. Throws std::invalid_argument if the field is none of these.
+///
+/// @param text cost field
+/// @param mana_cost gets the printed cost, 0 if it depends on the target
+///
+/// @return cost rule
+SpellCost Spell::parseCost(std::string_view text, int &mana_cost)
+{
+  mana_cost = 0;
+  if (text == SPELL_XX_MANA_TEXT "/2")
+    return SpellCost::HALF_TARGET;
+  if (text == SPELL_XX_MANA_TEXT "+1")
+    return SpellCost::TARGET_PLUS_ONE;
+  mana_cost = parseNumber(text);
+  return SpellCost::FIXED;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Parses the target field of the codebook. Throws std::invalid_argument if it is unknown.
+///
+/// @param text "none", "creature" or "graveyard"
+///
+/// @return target of the spell
+SpellTarget Spell::parseTarget(std::string_view text)
+{
+  if (text == "none")
+    return SpellTarget::NONE;
+  if (text == "creature")
+    return SpellTarget::CREATURE;
+  if (text == "graveyard")
+    return SpellTarget::GRAVEYARD;
+  throw std::invalid_argument(std::string(text));
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Compiles the effect field of the codebook, opcode names separated by spaces, each followed by its
+/// argument if it has one. The argument of "trait" is the trait letter. Throws std::invalid_argument for
+/// unknown opcodes, missing arguments and programs longer than SPELL_PROGRAM_LENGTH.
+///
+/// @param text effect field, e.g. "own attack 3 trait H"
+/// @param program gets the compiled program
+///
+/// @return length of the program
+uint8_t Spell::parseProgram(std::string_view text, SpellOp (&program)[SPELL_PROGRAM_LENGTH])
+{
+  auto nextWord = [&text]()
+  {
+    size_t start = text.find_first_not_of(' ');
+    text.remove_prefix(start == std::string_view::npos ? text.size() : start);
+    size_t end = std::min(text.find(' '), text.size());
+    std::string_view word = text.substr(0, end);
+    text.remove_prefix(end);
+    return word;
+  };
+
+  uint8_t length = 0;
+  for (std::string_view word = nextWord(); !word.empty(); word = nextWord())
+  {
+    int opcode = 0;
+    while (opcode < static_cast<int>(SpellOpcode::COUNT) && word != SPELL_OPCODE_NAMES[opcode])
+      opcode++;
+    if (opcode == static_cast<int>(SpellOpcode::COUNT) || length == SPELL_PROGRAM_LENGTH)
+      throw std::invalid_argument(std::string(word));
+
+    int argument = 0;
+    if (SPELL_OPCODE_ARGUMENTS[opcode])
+    {
+      std::string_view value = nextWord();
+      if (static_cast<SpellOpcode>(opcode) == SpellOpcode::TRAIT)
+        argument = value.size() == 1 ? Creature::traitFromChar(value[0]) : Trait::NON;
+      else if (!value.empty())
+        argument = parseNumber(value);
+      if (argument <= 0 || argument > INT8_MAX)
+        throw std::invalid_argument(std::string(word));
+    }
+    program[length++] = {static_cast<SpellOpcode>(opcode), static_cast<int8_t>(argument)};
+  }
+  return length;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Calculates the mana needed to cast the spell on a target
+///
+/// @param target target creature, nullptr = spell without target
+///
+/// @return mana cost
+int Spell::getManaCost(const Creature *target) const
+{
+  switch (prototype_->cost)
+  {
+  case SpellCost::HALF_TARGET:
+    return (target->getManaCost() + 1) / 2;
+  case SpellCost::TARGET_PLUS_ONE:
+    return target->getManaCost() + 1;
+  case SpellCost::FIXED:
+    break;
+  }
+  return prototype_->mana_cost;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Calculates the mana a player needs to cast the spell. A spell whose cost depends on its target is
+/// checked against a cost of 0 and charged in full when it is cast, so the mana may drop below 0.
+///
+/// @return mana needed
+int Spell::getRequiredMana() const
 {
-  has_mana_ = true;
+  return prototype_->cost == SpellCost::FIXED ? prototype_->mana_cost : 0;
 }
 
 //-----------------------------------------------------------------------------------------------------
@@ -15,43 +305,46 @@ Spell::Spell(std::string name, std::string ID, int mana_cost, std::string effect
 ///
 /// @param border_info border information
 /// @param border_d border data
+/// @param out stream to print to
 ///
 /// @return nothing
-void Spell::printInfo(std::string border_info, std::string border_d)
+void Spell::printInfo(std::string border_info, std::string border_d, std::ostream &out)
 {
-  std::cout << border_info << std::endl;
-  if (mana_cost_)
+  out << border_info << std::endl;
+  if (prototype_->cost == SpellCost::FIXED)
   {
-    std::cout << getCardName() << " [" << getCardID() << "] " << "(" << getManaCost() << " mana" << ")" << std::endl;
+    out << getCardName() << " [" << getCardID() << "] " << "(" << prototype_->mana_cost << " mana" << ")" << std::endl;
   }
   else
   {
-    std::cout << getCardName() << " [" << getCardID() << "] " << "(" << "XX mana" << ")" << std::endl;
+    out << getCardName() << " [" << getCardID() << "] " << "(" << "XX mana" << ")" << std::endl;
   }
-  std::cout << "Type: Spell" << std::endl
-            << "Effect: " << getEffect() << std::endl
-            << border_d << std::endl;
+  out << "Type: Spell" << std::endl
+      << "Effect: " << getEffect() << std::endl
+      << border_d << std::endl;
 }
 
 std::vector<std::string> Spell::printCard() const
 {
+  AllocationScope scope(AllocationSubsystem::CARDS);
   std::vector<std::string> card;
 
   // line 1
-  std::string mana_str = std::to_string(mana_cost_);
-  if (!mana_cost_)
+  int mana_cost = prototype_->mana_cost;
+  std::string mana_str = std::to_string(mana_cost);
+  if (prototype_->cost != SpellCost::FIXED)
   {
     mana_str = "XX";
   }
   else if (mana_str.length() == 1)
     mana_str = "0" + mana_str;
-  else if (mana_cost_ > 99)
+  else if (mana_cost > 99)
     mana_str = "**";
 
   card.push_back(" _____M" + mana_str);
 
   // line 2
-  card.push_back("| " + ID_ + " |");
+  card.push_back("| " + prototype_->id + " |");
 
   // line 3
   card.push_back("|       |");
@@ -64,180 +357,23 @@ std::vector<std::string> Spell::printCard() const
 
 //-----------------------------------------------------------------------------------------------------
 ///
-/// Checks what type of spell it is
-///
-/// @param card_id card id
-///
-/// @return 0 = not a spell, 1 = General spell, 2 = Target spell, 3 = Graveyard spell
-int Spell::getSpellCardType(std::string card_id)
-{
-  if (card_id == "BTLCY" || card_id == "METOR" || card_id == "FIRBL")
-    return 1;
-  else if (card_id == "CLONE" || card_id == "CURSE" || card_id == "SHOCK" ||
-           card_id == "MOBLZ" || card_id == "RRUSH" || card_id == "SHILD" ||
-           card_id == "AMPUT" || card_id == "FINAL" || card_id == "LYLTY" ||
-           card_id == "ZMBFY" || card_id == "BLOOD")
-    return 2;
-  else if (card_id == "MEMRY" || card_id == "REVIV")
-    return 3;
-
-  return 0;
-}
-
-//-----------------------------------------------------------------------------------------------------
-///
-/// Processes the logic for all of the spells
+/// Casts the spell: runs its program with the target selected. The mana is paid by the caller.
 ///
-/// @param card_id card id
 /// @param player player
 /// @param opponent opponent
 /// @param board board
-/// @param affected_creature affected creature
+/// @param target target creature, nullptr = spell without target
 /// @param round current round number
+/// @param arena arena of the game, new creatures are created in it
 ///
 /// @return nothing
-void Spell::processSpell(std::string card_id, Player& player, Player& opponent,
-                         Board &board, std::shared_ptr<Creature> &affected_creature, int round)
+void Spell::cast(Player &player, Player &opponent, Board &board, std::shared_ptr<Creature> &target, int round,
+                 const std::shared_ptr<CardArena> &arena) const
 {
-  if (card_id == "BTLCY")
-  {
-    std::shared_ptr<Creature> current_card = nullptr;
-    for (int i = 0; i < 7; i++)
-    {
-      current_card = board.fetchFieldCard(player.getPlayerNumber(), i);
-      if (current_card != nullptr)
-      {
-        current_card->increaseCurrentAttack(3);
-        current_card->addTrait(H);
-        current_card->addTrait(T);
-      }
-
-      current_card = board.fetchBattleCard(player.getPlayerNumber(), i);
-      if (current_card != nullptr)
-      {
-        current_card->increaseCurrentAttack(3);
-        current_card->addTrait(H);
-        current_card->addTrait(T);
-      }
-    }
-  }
-  else if (card_id == "METOR")
-  {
-    for (int i = 0; i < 7; i++)
-    {
-      if (board.fetchBattleCard(1, i) != nullptr)
-        board.fetchBattleCard(1, i)->damageCreature(3);
-      if (board.fetchBattleCard(2, i) != nullptr)
-        board.fetchBattleCard(2, i)->damageCreature(3);
-    }
-    for (int i = 0; i < 7; i++)
-    {
-      if (board.fetchFieldCard(1, i) != nullptr)
-        board.fetchFieldCard(1, i)->damageCreature(3);
-      if (board.fetchFieldCard(2, i) != nullptr)
-        board.fetchFieldCard(2, i)->damageCreature(3);
-    }
-  }
-  else if (card_id == "FIRBL")
-  {
-    std::shared_ptr<Creature> current_card = nullptr;
-    for (int i = 0; i < 7; i++)
-    {
-      current_card = board.fetchBattleCard(opponent.getPlayerNumber(), i);
-      if (current_card == nullptr)
-        continue;
-      current_card->damageCreature(2);
-    }
-    for (int i = 0; i < 7; i++)
-    {
-      current_card = board.fetchFieldCard(opponent.getPlayerNumber(), i);
-      if (current_card == nullptr)
-        continue;
-      current_card->damageCreature(2);
-    }
-  }
-
-  else if (card_id == "CLONE")
-  {
-    player.subtractMana((affected_creature->getManaCost() + 1) / 2);
-    std::shared_ptr<Creature> cloned_creature = std::dynamic_pointer_cast<Creature>(createCardFromID(affected_creature->getCardID()));
-    cloned_creature->setCurrentAttack(affected_creature->getCurrentAttack());
-    cloned_creature->setCurrentHealth(affected_creature->getCurrentHealth());
-    cloned_creature->setCurrentTraits(affected_creature->getTraits());
-    cloned_creature->addTrait(H);
-    cloned_creature->addTrait(T);
-    cloned_creature->setRoundPlacement(round);
-    board.placeCard(cloned_creature, player.getPlayerNumber() - 1, -1);
-  }
-  else if (card_id == "CURSE")
-  {
-    player.subtractMana(affected_creature->getManaCost() + 1);
-    affected_creature->addTrait(T);
-  }
-  else if (card_id == "SHOCK")
-  {
-    affected_creature->damageCreature(1);
-  }
-  else if (card_id == "MOBLZ")
-  {
-    affected_creature->addTrait(H);
-
-    affected_creature->increaseCurrentAttack(1);
-  }
-  else if (card_id == "RRUSH")
-  {
-    affected_creature->addTrait(F);
-    affected_creature->addTrait(T);
-    affected_creature->increaseCurrentAttack(2);
-  }
-  else if (card_id == "SHILD")
-  {
-    affected_creature->increaseCurrentHealth(2);
-  }
-  else if (card_id == "AMPUT")
-  {
-    affected_creature->removeTrait();
-  }
-  else if (card_id == "FINAL")
-  {
-    affected_creature->addTrait(B);
-    affected_creature->addTrait(H);
-    affected_creature->addTrait(T);
-    affected_creature->increaseCurrentAttack(3);
-  }
-  else if (card_id == "LYLTY")
-  {
-    affected_creature->addTrait(H);
-    affected_creature->increaseCurrentHealth(1);
-  }
-  else if (card_id == "ZMBFY")
-  {
-    affected_creature->addTrait(V);
-    affected_creature->addTrait(U);
-  }
-  else if (card_id == "BLOOD")
-  {
-    affected_creature->addTrait(B);
-    affected_creature->addTrait(L);
-    affected_creature->setCurrentHealth((affected_creature->getCurrentHealth() + 1) / 2);
-  }
-  else if (card_id == "MEMRY")
-  {
-    if (!board.areAllFieldsFull(player.getPlayerNumber()))
-    {
-      player.removeFromGraveyard(affected_creature->getCardID());
-      affected_creature->resetAttributes();
-      affected_creature->addTrait(H);
-      affected_creature->addTrait(T);
-      affected_creature->setRoundPlacement(round);
-      board.placeCard(affected_creature, player.getPlayerNumber() - 1, -1);
-    }
-    player.subtractMana(((affected_creature->getManaCost() + 1) / 2));
-  }
-  else if (card_id == "REVIV")
+  SpellContext context{player, opponent, board, target, round, arena, {target.get()}, target ? 1 : 0, nullptr};
+  for (uint8_t index = 0; index < prototype_->program_length; index++)
   {
-    player.removeFromGraveyard(affected_creature->getCardID());
-    affected_creature->resetAttributes();
-    player.addCardToHand(affected_creature);
+    const SpellOp &op = prototype_->program[index];
+    SPELL_HANDLERS[static_cast<int>(op.opcode)](context, op.argument);
   }
 }
@@ -5,37 +5,111 @@
 
 #include "Card.hpp"
 #include <string>
+#include <string_view>
+#include <cstdint>
 #include "Player.hpp"
 #include "Board.hpp"
 
+#define SPELL_PROGRAM_LENGTH 8
+#define SPELL_SELECTION_SIZE 28
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// What a spell is cast on: nothing, a creature on the board or a creature in the player's graveyard
+///
+enum class SpellTarget : uint8_t
+{
+  NONE,
+  CREATURE,
+  GRAVEYARD
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// How the mana cost of a spell is calculated: the printed cost, half the target's cost rounded up or
+/// the target's cost plus 1
+///
+enum class SpellCost : uint8_t
+{
+  FIXED,
+  HALF_TARGET,
+  TARGET_PLUS_ONE
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Effect opcodes of the spell programs. The effects work on the selected creatures, which are the
+/// target of the spell at the start. OWN, ENEMY and ALL select the creatures on the board instead, CLONE
+/// and TO_FIELD select the creature they place.
+///
+enum class SpellOpcode : uint8_t
+{
+  OWN,
+  ENEMY,
+  ALL,
+  DAMAGE,
+  ATTACK,
+  HEALTH,
+  TRAIT,
+  REMOVE_TRAIT,
+  DIVIDE_HEALTH,
+  CLONE,
+  TO_FIELD,
+  TO_HAND,
+  COUNT
+};
+
+struct SpellOp
+{
+  SpellOpcode opcode;
+  int8_t argument;
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Everything that all spells with the same ID have in common: the card texts, the cost rule, the
+/// target and the effect program. Prototypes are never changed or freed, the spells only point to them.
+///
+struct SpellPrototype
+{
+  std::string name;
+  std::string id;
+  int mana_cost;
+  SpellCost cost;
+  SpellTarget target;
+  std::string effect;
+  uint8_t program_length;
+  SpellOp program[SPELL_PROGRAM_LENGTH];
+};
+
 class Spell : public Card
 {
 protected:
-  bool has_mana_;
-  int mana_cost_;
-  std::string effect_;
+  const SpellPrototype *prototype_;
 
 public:
   // Forward declarations
-  Spell() {};
-  Spell(std::string name, std::string ID, int mana_cost, std::string effect);
+  explicit Spell(const SpellPrototype *prototype);
   ~Spell() = default;
   Spell(const Spell &) = delete;
 
-  void printInfo(std::string border_info, std::string border_d) override;
-  std::vector<std::string> printCard() const override;
+  static const SpellPrototype *findPrototype(const std::string &ID);
+  static SpellCost parseCost(std::string_view text, int &mana_cost);
+  static SpellTarget parseTarget(std::string_view text);
+  static uint8_t parseProgram(std::string_view text, SpellOp (&program)[SPELL_PROGRAM_LENGTH]);
 
-  void setManaCost(int mana_cost) { mana_cost_ = mana_cost; }
-  int getManaCost() { return mana_cost_; }
-  void setXXManaCost() { mana_cost_ = 0; }
+  void printInfo(std::string border_info, std::string border_d, std::ostream &out) override;
+  std::vector<std::string> printCard() const override;
 
-  void setEffect(std::string effect) { effect_ = effect; }
-  std::string getEffect() { return effect_; }
+  const std::string &getCardID() const override { return prototype_->id; }
+  const std::string &getCardName() const override { return prototype_->name; }
+  const std::string &getEffect() const { return prototype_->effect; }
+  SpellTarget getTarget() const { return prototype_->target; }
+  int getManaCost(const Creature *target) const;
+  int getRequiredMana() const;
 
-  int getSpellCardType(std::string cardID);
-  void processSpell(std::string card_id, Player &player, Player &opponent, Board &board,
-                    std::shared_ptr<Creature> &affected_creature, int round);
-  bool hasMana() { return has_mana_; }
+  void cast(Player &player, Player &opponent, Board &board, std::shared_ptr<Creature> &target, int round,
+            const std::shared_ptr<CardArena> &arena) const;
 };
 
 #endif
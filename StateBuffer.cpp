@@ -0,0 +1,104 @@
+#include "StateBuffer.hpp"
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Appends an unsigned number as a variable-length integer
+///
+/// @param value number to append
+///
+/// @return nothing
+void StateWriter::writeUnsigned(uint64_t value)
+{
+  while (value >= 0x80)
+  {
+    bytes_.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  bytes_.push_back(static_cast<uint8_t>(value));
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Appends a signed number, zigzag encoded so small negative numbers stay short
+///
+/// @param value number to append
+///
+/// @return nothing
+void StateWriter::writeSigned(int64_t value)
+{
+  writeUnsigned((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Appends text without a length, used for the magic of the format
+///
+/// @param text text to append
+///
+/// @return nothing
+void StateWriter::writeText(const std::string &text)
+{
+  bytes_.insert(bytes_.end(), text.begin(), text.end());
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Reads one byte
+///
+/// @return byte, 0 = end of the data reached
+uint8_t StateReader::readByte()
+{
+  if (failed_ || position_ >= size_)
+  {
+    failed_ = true;
+    return 0;
+  }
+  return data_[position_++];
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Reads a variable-length unsigned number
+///
+/// @return number, 0 = malformed or end of the data reached
+uint64_t StateReader::readUnsigned()
+{
+  uint64_t value = 0;
+  for (int shift = 0; shift < 64; shift += 7)
+  {
+    uint8_t byte = readByte();
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      return failed_ ? 0 : value;
+  }
+  failed_ = true;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Reads a zigzag encoded signed number
+///
+/// @return number, 0 = malformed or end of the data reached
+int64_t StateReader::readSigned()
+{
+  uint64_t value = readUnsigned();
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Reads text written with StateWriter::writeText and compares it
+///
+/// @param text expected text
+///
+/// @return true = the data contains the text, false = different text, the reader is failed
+bool StateReader::readText(const std::string &text)
+{
+  for (char letter : text)
+  {
+    if (readByte() != static_cast<uint8_t>(letter))
+      failed_ = true;
+  }
+  return !failed_;
+}
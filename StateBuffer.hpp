@@ -0,0 +1,62 @@
+#ifndef STATEBUFFER_HPP
+#define STATEBUFFER_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#define GAME_STATE_MAGIC "MSAV"
+#define GAME_STATE_MAGIC_SIZE 4
+#define GAME_STATE_VERSION 2
+#define SAVED_GAME_FILE "data/saved_game.bin"
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Appends the fields of a saved game to a byte buffer. Numbers are stored as variable-length integers,
+/// 7 bits per byte, signed numbers zigzag encoded first, so small values take a single byte.
+///
+class StateWriter
+{
+protected:
+  std::vector<uint8_t> bytes_;
+
+public:
+  // Forward declarations
+  StateWriter() = default;
+  ~StateWriter() = default;
+
+  void writeByte(uint8_t value) { bytes_.push_back(value); }
+  void writeUnsigned(uint64_t value);
+  void writeSigned(int64_t value);
+  void writeText(const std::string &text);
+  const std::vector<uint8_t> &getBytes() const { return bytes_; }
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Reads the fields written by a StateWriter. Reading past the end or a malformed number sets the
+/// reader to failed; it then returns zeros, so the caller only has to check isFailed() at the end.
+///
+class StateReader
+{
+protected:
+  const uint8_t *data_;
+  size_t size_;
+  size_t position_;
+  bool failed_;
+
+public:
+  // Forward declarations
+  StateReader(const uint8_t *data, size_t size) : data_(data), size_(size), position_(0), failed_(false) {}
+  ~StateReader() = default;
+
+  uint8_t readByte();
+  uint64_t readUnsigned();
+  int64_t readSigned();
+  bool readText(const std::string &text);
+  bool isFailed() const { return failed_; }
+  bool isAtEnd() const { return position_ == size_; }
+};
+
+#endif
@@ -0,0 +1,120 @@
+#include "TraitHooks.hpp"
+#include "Game.hpp"
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// What every trait does, in the order the hooks of a phase run:
+///   F  strikes before a creature without First Strike
+///   H  may battle in the round it was placed
+///   C  pulls the opposite creature of the opponent into battle
+///   B  deals the excess damage of a kill to the defending player
+///   L  heals 2 after dealing damage
+///   V  poisons the creature it damaged
+///   T  leaves the board after the battle
+///   U  returns from the graveyard after the battle, once
+///   R  regains its base health at the start of every other round
+///   P  takes 1 damage at the start of every round of its player
+///
+static constexpr TraitHook TRAIT_HOOKS[] = {
+    {Trait::F, TraitPhase::FIRST_STRIKE, nullptr},
+    {Trait::H, TraitPhase::ENTER_BATTLE, &Game::hasteHook},
+    {Trait::C, TraitPhase::ENTER_BATTLE, &Game::challengerHook},
+    {Trait::B, TraitPhase::ATTACK, &Game::brutalHook},
+    {Trait::L, TraitPhase::ATTACK, &Game::lifestealHook},
+    {Trait::V, TraitPhase::ATTACK, &Game::venomousHook},
+    {Trait::T, TraitPhase::END_OF_BATTLE, &Game::temporaryHook},
+    {Trait::U, TraitPhase::DEATH, &Game::undyingHook},
+    {Trait::R, TraitPhase::UPKEEP, &Game::regenerateHook},
+    {Trait::P, TraitPhase::UPKEEP, &Game::poisonedHook},
+};
+
+static constexpr bool fitsPhaseTables()
+{
+  for (int phase = 0; phase < static_cast<int>(TraitPhase::COUNT); phase++)
+  {
+    int count = 0;
+    for (const TraitHook &hook : TRAIT_HOOKS)
+      count += static_cast<int>(hook.phase) == phase;
+    if (count > TRAIT_PHASE_HOOK_LIMIT)
+      return false;
+  }
+  return true;
+}
+static_assert(fitsPhaseTables(), "too many trait hooks in one phase");
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// The specialized fight resolvers in Game.cpp call the ATTACK hooks directly, in the order B, L, V,
+/// and only know the traits of FIGHT_TRAIT_MASK
+///
+static constexpr bool matchesFightResolvers()
+{
+  const Trait order[] = {Trait::B, Trait::L, Trait::V};
+  int attack_hooks = 0;
+  for (const TraitHook &hook : TRAIT_HOOKS)
+  {
+    if (hook.phase == TraitPhase::FIRST_STRIKE && hook.trait != Trait::F)
+      return false;
+    if (hook.phase != TraitPhase::ATTACK)
+      continue;
+    if (attack_hooks == 3 || hook.trait != order[attack_hooks] || !(traitBit(hook.trait) & FIGHT_TRAIT_MASK))
+      return false;
+    attack_hooks++;
+  }
+  return attack_hooks == 3;
+}
+static_assert(matchesFightResolvers(), "fight traits changed, update the fight resolvers in Game.cpp");
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Compiles the trait declarations into the dispatch tables of the phases
+///
+/// @return nothing
+TraitRegistry::TraitRegistry()
+{
+  for (const TraitHook &hook : TRAIT_HOOKS)
+  {
+    TraitPhaseTable &table = phases_[static_cast<int>(hook.phase)];
+    table.mask |= traitBit(hook.trait);
+    if (!hook.handler)
+      continue;
+    table.bits[table.hook_count] = traitBit(hook.trait);
+    table.handlers[table.hook_count] = hook.handler;
+    table.hook_count++;
+  }
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Registry of all games, compiled when the first game is created
+///
+/// @return the registry
+const TraitRegistry &TraitRegistry::get()
+{
+  static const TraitRegistry registry;
+  return registry;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Runs the hooks of a phase. Every hook visits all creatures that have its trait before the next hook
+/// runs, so the messages of one trait stay together.
+///
+/// @param game game the hooks act on
+/// @param phase phase
+/// @param events creatures of the phase in the order they are visited
+/// @param count number of events
+///
+/// @return nothing
+void TraitRegistry::dispatch(Game &game, TraitPhase phase, TraitEvent *events, int count) const
+{
+  const TraitPhaseTable &table = getPhase(phase);
+  for (int hook = 0; hook < table.hook_count; hook++)
+  {
+    for (int index = 0; index < count; index++)
+    {
+      if (!events[index].removed && (events[index].creature->getTraitMask() & table.bits[hook]))
+        (game.*table.handlers[hook])(events[index]);
+    }
+  }
+}
@@ -0,0 +1,121 @@
+#ifndef TRAITHOOKS_HPP
+#define TRAITHOOKS_HPP
+
+#include <cstdint>
+
+#include "Creature.hpp"
+
+#define TRAIT_PHASE_HOOK_LIMIT 8
+#define TRAIT_BOARD_EVENT_LIMIT 28
+#define FIGHT_TRAIT_B 1
+#define FIGHT_TRAIT_F 2
+#define FIGHT_TRAIT_L 4
+#define FIGHT_TRAIT_V 8
+#define FIGHT_TRAIT_COMBINATIONS 16
+
+class Game;
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Traits that change how a fight is resolved: First Strike and the ATTACK hooks
+///
+constexpr uint16_t FIGHT_TRAIT_MASK = traitBit(Trait::B) | traitBit(Trait::F) | traitBit(Trait::L) |
+                                      traitBit(Trait::V);
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Packs the fight traits of a trait mask into 4 bits, the index of the specialized fight resolvers
+///
+/// @param traits trait mask of a creature
+///
+/// @return FIGHT_TRAIT_* bits
+constexpr uint8_t fightTraits(uint16_t traits)
+{
+  return static_cast<uint8_t>(((traits >> Trait::B) & 1) | ((traits >> Trait::F) & 1) << 1 |
+                              ((traits >> Trait::L) & 1) << 2 | ((traits >> Trait::V) & 1) << 3);
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Points of the game at which traits act. FIRST_STRIKE has no hooks, a trait in it only changes the
+/// order of the fight.
+///
+enum class TraitPhase : uint8_t
+{
+  FIRST_STRIKE,
+  ENTER_BATTLE,
+  ATTACK,
+  END_OF_BATTLE,
+  DEATH,
+  UPKEEP,
+  COUNT
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// One creature a phase visits. slot is the board slot, or the graveyard index in the DEATH phase;
+/// target and value depend on the phase, e.g. the defending creature and the excess damage of an attack.
+/// A hook sets removed when it took the creature out of its zone.
+///
+struct TraitEvent
+{
+  Creature *creature = nullptr;
+  Creature *target = nullptr;
+  int player = 0;
+  int slot = -1;
+  bool battle = false;
+  int value = 0;
+  bool removed = false;
+};
+
+typedef void (Game::*TraitHandler)(TraitEvent &event);
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Declaration of what a trait does in a phase
+///
+struct TraitHook
+{
+  Trait trait;
+  TraitPhase phase;
+  TraitHandler handler;
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Hooks of one phase in the order they run, and the mask of all traits that have one. A creature whose
+/// traits are not in the mask is never visited by the phase.
+///
+struct TraitPhaseTable
+{
+  uint16_t mask = 0;
+  uint8_t hook_count = 0;
+  uint16_t bits[TRAIT_PHASE_HOOK_LIMIT] = {};
+  TraitHandler handlers[TRAIT_PHASE_HOOK_LIMIT] = {};
+};
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Per-phase dispatch tables compiled once from the trait declarations in TraitHooks.cpp. The tables
+/// are never changed afterwards, so all games and threads share them.
+///
+class TraitRegistry
+{
+protected:
+  TraitPhaseTable phases_[static_cast<int>(TraitPhase::COUNT)];
+
+  TraitRegistry();
+
+public:
+  // Forward declarations
+  TraitRegistry(const TraitRegistry &) = delete;
+  ~TraitRegistry() = default;
+
+  static const TraitRegistry &get();
+
+  const TraitPhaseTable &getPhase(TraitPhase phase) const { return phases_[static_cast<int>(phase)]; }
+  uint16_t getMask(TraitPhase phase) const { return phases_[static_cast<int>(phase)].mask; }
+  void dispatch(Game &game, TraitPhase phase, TraitEvent *events, int count) const;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include <utility>
+
+#include "TurnSession.hpp"
+#include "Game.hpp"
+
+TurnSession::TurnSession(TurnSession &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+TurnSession &TurnSession::operator=(TurnSession &&other) noexcept
+{
+  if (this != &other)
+  {
+    if (handle_)
+      handle_.destroy();
+    handle_ = std::exchange(other.handle_, nullptr);
+  }
+  return *this;
+}
+
+TurnSession::~TurnSession()
+{
+  if (handle_)
+    handle_.destroy();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Starts the rounds of a game. The session runs until it needs the first command, or to the end if the
+/// game is already decided.
+///
+/// @param game game to play, it has to outlive the session
+/// @param start_round true = a new game, false = a resumed game continues in the middle of its round
+///
+/// @return session waiting for the first command
+TurnSession TurnSession::play(Game &game, bool start_round)
+{
+  TurnSession session = playRounds(game, start_round);
+  session.rethrow();
+  return session;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// The coroutine of the session. The phases themselves are played by Game::applyAction, which the bots
+/// use for their searches as well: the done of the attacker hands over to the defender, the done of the
+/// defender plays the battle and starts the next round.
+///
+/// @param game game to play
+/// @param start_round true = start the first round
+///
+/// @return session, its game status is set when it has finished, 0 = quit
+TurnSession TurnSession::playRounds(Game &game, bool start_round)
+{
+  int game_status = start_round ? game.startRound() : 0;
+  while (!game_status)
+  {
+    // attacker commands, defender commands, battle and end checks of one round
+    int round = game.getRound();
+    while (!game_status && game.getRound() == round)
+    {
+      Command command = co_await CommandRequest{game.getActivePlayerNumber()};
+      if (command.isQuit())
+        co_return 0;
+      game_status = game.applyAction(command);
+    }
+  }
+  co_return game_status;
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Plays a command of the player the session is waiting for and runs until it needs the next one
+///
+/// @param command command of the player, a quit ends the session without a game status
+///
+/// @return nothing
+void TurnSession::resume(Command command)
+{
+  if (handle_.done())
+    return;
+  handle_.promise().command = command;
+  handle_.resume();
+  rethrow();
+}
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// Passes an exception of the game, e.g. MemoryEx, on to the caller that resumed the session
+///
+/// @return nothing
+void TurnSession::rethrow() const
+{
+  if (handle_.promise().exception)
+    std::rethrow_exception(handle_.promise().exception);
+}
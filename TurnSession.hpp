@@ -0,0 +1,75 @@
+#ifndef TURNSESSION_HPP
+#define TURNSESSION_HPP
+
+#include <coroutine>
+#include <exception>
+
+#include "Command.hpp"
+
+class Game;
+
+//-----------------------------------------------------------------------------------------------------
+///
+/// The rounds of one game as a coroutine: start of the round, the commands of the attacker, the commands
+/// of the defender, the battle and the end checks. The session suspends whenever it needs the next
+/// command and keeps its place in the round while suspended, so whoever holds it (the command line, a
+/// bot, a socket or a script) drives the game by resuming it with a command, and one thread can drive
+/// any number of games. Not thread-safe, but a session may be resumed by a different thread each time.
+///
+class TurnSession
+{
+public:
+  struct promise_type
+  {
+    Command command{CommandType::INVALID};
+    int player = 0;
+    int game_status = 0;
+    std::exception_ptr exception;
+
+    TurnSession get_return_object() { return TurnSession(std::coroutine_handle<promise_type>::from_promise(*this)); }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_value(int status) { game_status = status; }
+    void unhandled_exception() { exception = std::current_exception(); }
+  };
+
+  //---------------------------------------------------------------------------------------------------
+  ///
+  /// Suspends the session until the player has entered a command, co_await returns the command
+  ///
+  struct CommandRequest
+  {
+    int player;
+    promise_type *promise = nullptr;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+    {
+      promise = &handle.promise();
+      promise->player = player;
+    }
+    Command await_resume() const { return promise->command; }
+  };
+
+  // Forward declarations
+  TurnSession(TurnSession &&other) noexcept;
+  TurnSession &operator=(TurnSession &&other) noexcept;
+  TurnSession(const TurnSession &) = delete;
+  ~TurnSession();
+
+  static TurnSession play(Game &game, bool start_round);
+
+  void resume(Command command);
+  bool isFinished() const { return handle_.done(); }
+  int getPlayer() const { return handle_.promise().player; }
+  int getGameStatus() const { return handle_.promise().game_status; }
+
+private:
+  std::coroutine_handle<promise_type> handle_;
+
+  explicit TurnSession(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+  static TurnSession playRounds(Game &game, bool start_round);
+  void rethrow() const;
+};
+
+#endif
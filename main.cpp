@@ -15,6 +15,17 @@
 //
 
 #include <iostream>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <random>
+#include <fstream>
+#include <iterator>
+#include <csignal>
+#include <unistd.h>
+#include <thread>
+#include <algorithm>
+#include <charconv>
 
 #include "Command.hpp"
 #include "CommandLine.hpp"
@@ -22,38 +33,447 @@
 #include "Player.hpp"
 #include "Game.hpp"
 #include "Exeption.hpp"
+#include "Bot.hpp"
+#include "HumanController.hpp"
+#include "BotController.hpp"
+#include "SolveTable.hpp"
+#include "OpeningBook.hpp"
+#include "ConfigCorpus.hpp"
+#include "Simulator.hpp"
+#include "ResultsLog.hpp"
+#include "EventLog.hpp"
+#include "AllocationTracker.hpp"
+#include "GameServer.hpp"
+#include "TurnSession.hpp"
+#include "JobScheduler.hpp"
 
 #define MEM_ERROR_MESSAGE "[ERROR] Not enough memory!"
 #define WRONG_PARAM_MESSAGE "[ERROR] Wrong number of parameters."
 #define INVALID_FILE_MESSAGE "[ERROR] Invalid file "
+#define INVALID_POSITION_MESSAGE "[ERROR] Invalid position."
+#define INPUT_POLL_INTERVAL_MS 50
+#define PLAYOUT_PHASE_ACTION_LIMIT 32
 
 enum Returns
 {
   SUCCESSFUL = 0,
   INVALID_MEMORY = 1,
   WRONG_NUMBER_OF_PARAMETERS = 2,
-  INVALID_FILE = 3
+  INVALID_FILE = 3,
+  CHECK_FAILED = 4
 };
 
 
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// Reads the number of a command line option like --think=<ms>. Only plain decimal digits are accepted.
+///
+/// @param text number part of the option
+/// @param value set to the number, unchanged if the text is invalid
+///
+/// @return true = valid number that fits into the value, false = invalid or too large
+//
+template <typename Number>
+static bool parseOptionNumber(const std::string &text, Number &value)
+{
+  if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos)
+    return false;
+  const char *end = text.data() + text.size();
+  auto result = std::from_chars(text.data(), end, value);
+  return result.ec == std::errc() && result.ptr == end;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// Waits for the next action of a player. A quit entered while a computer player is searching cancels
+/// the search right away.
+///
+/// @param controller controller of the player to move, the turn has been started
+/// @param commandLine command line of the game
+///
+/// @return decided action, or a quit command
+//
+static Command awaitAction(PlayerController &controller, CommandLine &commandLine)
+{
+  while (!controller.waitForAction(std::chrono::milliseconds(INPUT_POLL_INTERVAL_MS)))
+  {
+    if (commandLine.isQuitRequested())
+    {
+      controller.cancel();
+      return Command(CommandType::QUIT);
+    }
+  }
+  return controller.takeAction();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// Plays every match of a config corpus with bots on both sides and prints the results
+///
+/// @param init loaded messages and codebook
+/// @param corpus_path corpus file or directory
+/// @param think_time think time of the bots per action
+/// @param event_log log for the events of all matches, nullptr = no event log
+/// @param allocations report for the allocations of all matches, nullptr = allocations are not reported
+/// @param thread_count number of matches played at the same time
+///
+/// @return 0 = success, 1 = memory error, 3 = invalid corpus
+//
+static int runBatch(const Init &init, const std::string &corpus_path, long think_time, EventLog *event_log,
+                    AllocationReport *allocations, unsigned int thread_count)
+{
+  std::vector<std::string> card_ids;
+  for (const auto &creature : init.getCreatureCodebook())
+    card_ids.push_back(creature->getCardID());
+  for (const auto &spell : init.getSpellCodebook())
+    card_ids.push_back(spell->getCardID());
+
+  try
+  {
+    ConfigCorpus corpus(corpus_path, card_ids, 0);
+    for (const std::string &error : corpus.getErrors())
+    {
+      std::cout << INVALID_FILE_MESSAGE << error << std::endl;
+    }
+
+    std::shared_ptr<SolveTable> solve_table = nullptr;
+    try
+    {
+      solve_table = std::make_shared<SolveTable>(SOLVE_TABLE_FILE);
+    }
+    catch (const file_error &e)
+    {
+      std::cout << e.what() << std::endl;
+    }
+
+    std::unique_ptr<ResultsLog> results_log = nullptr;
+    try
+    {
+      results_log = std::make_unique<ResultsLog>(RESULTS_LOG_FILE);
+    }
+    catch (const file_error &e)
+    {
+      std::cout << e.what() << std::endl;
+    }
+
+    Simulator simulator(corpus, init, std::chrono::milliseconds(think_time), solve_table, results_log.get(),
+                        std::random_device{}(), event_log, allocations);
+    simulator.setThreadCount(thread_count);
+    // the live progress goes to the terminal only, the results on standard output stay clean
+    if (isatty(STDERR_FILENO))
+      simulator.setProgressStream(&std::cerr);
+    simulator.run(std::cout);
+    if (results_log && !results_log->close())
+    {
+      const std::map<std::string, std::string> infos = init.getInfos();
+      auto message = infos.find("I_FILE_WRITE_FAILED");
+      if (message != infos.end())
+        std::cout << "[INFO] " << message->second << std::endl;
+    }
+  }
+  catch (const file_error &e)
+  {
+    std::cout << e.what() << std::endl;
+    return INVALID_FILE;
+  }
+  catch (const MemoryEx &e)
+  {
+    std::cout << MEM_ERROR_MESSAGE << std::endl;
+    return INVALID_MEMORY;
+  }
+  return SUCCESSFUL;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// Plays a game to the end without searching: three of four actions are the best by the position
+/// evaluation, the others are random. A phase is finished after PLAYOUT_PHASE_ACTION_LIMIT actions.
+///
+/// @param start game before its first round
+/// @param seed seed of the random actions
+///
+/// @return game status at the end
+//
+static int playout(const Game &start, uint64_t seed)
+{
+  std::mt19937_64 generator(seed);
+  Game game(start);
+  game.setOutputStream(nullptr);
+  int game_status = game.startRound();
+  int phase_actions = 0;
+  int phase_player = game.getActivePlayerNumber();
+  while (!game_status)
+  {
+    if (game.getActivePlayerNumber() != phase_player)
+    {
+      phase_player = game.getActivePlayerNumber();
+      phase_actions = 0;
+    }
+
+    // done is always the last action
+    std::vector<Command> actions = game.generateActions();
+    unsigned long chosen = generator() % actions.size();
+    if (phase_actions++ >= PLAYOUT_PHASE_ACTION_LIMIT)
+    {
+      chosen = actions.size() - 1;
+    }
+    else if (generator() % 4)
+    {
+      double sign = game.getActivePlayerNumber() == 1 ? 1.0 : -1.0;
+      double best_value = 0.0;
+      for (unsigned long index = 0; index < actions.size(); index++)
+      {
+        Game next(game);
+        next.applyAction(actions[index]);
+        double value = sign * Bot::evaluatePosition(next);
+        if (index == 0 || value > best_value)
+        {
+          best_value = value;
+          chosen = index;
+        }
+      }
+    }
+    game_status = game.applyAction(actions[chosen]);
+  }
+  return game_status;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// Plays the same playouts of the loaded config with 1, 2, 4, ... up to all hardware threads and prints
+/// the time and the speedup over one thread. Every playout is a job of the scheduler, the results are
+/// the same for every number of threads.
+///
+/// @param init loaded messages, config and codebook
+/// @param p1 player 1 of the config
+/// @param p2 player 2 of the config
+/// @param games number of playouts per run
+///
+/// @return 0 = success, 1 = memory error
+//
+static int runScalingBenchmark(const Init &init, Player &p1, Player &p2, unsigned long games)
+{
+  Game start{p1, p2, init.getErrors(), init.getInfos(), init.getDescriptions(),
+             init.getMaxRounds(), init.getCreatureCodebook(), init.getSpellCodebook(), nullptr};
+
+  unsigned int max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  std::vector<unsigned int> thread_counts;
+  for (unsigned int threads = 1; threads < max_threads; threads *= 2)
+    thread_counts.push_back(threads);
+  thread_counts.push_back(max_threads);
+
+  std::cout << "Scaling benchmark: " << games << " playouts per run, up to " << max_threads << " threads"
+            << std::endl;
+  double single_thread_seconds = 0.0;
+  try
+  {
+    for (unsigned int threads : thread_counts)
+    {
+      JobScheduler scheduler(threads - 1);
+      std::vector<int> statuses(games, 0);
+      std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+      JobGroup playouts(scheduler);
+      for (unsigned long index = 0; index < games; index++)
+      {
+        const Game *position = &start;
+        int *status = &statuses[index];
+        playouts.run([position, index, status]
+                     { *status = playout(*position, index); });
+      }
+      playouts.wait();
+      double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+      if (threads == 1)
+        single_thread_seconds = seconds;
+
+      unsigned long wins[3] = {0, 0, 0};
+      for (int status : statuses)
+        wins[Game::winnerFromStatus(status)]++;
+      std::cout << "Threads " << threads << ": " << static_cast<long>(seconds * 1000) << " ms, "
+                << static_cast<long>(games / seconds) << " playouts/s, speedup "
+                << static_cast<long>(single_thread_seconds / seconds * 100) / 100.0 << "x, Player 1 wins: "
+                << wins[1] << ", Player 2 wins: " << wins[2] << ", ties: " << wins[0] << std::endl;
+    }
+  }
+  catch (const MemoryEx &e)
+  {
+    std::cout << MEM_ERROR_MESSAGE << std::endl;
+    return INVALID_MEMORY;
+  }
+  return SUCCESSFUL;
+}
+
+static GameServer *running_server = nullptr;
+
+static void stopServer(int)
+{
+  if (running_server)
+    running_server->stop();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+///
+/// Hosts games of the loaded config on a Unix domain socket until the server is interrupted. All sessions
+/// share the messages, the codebook and the solve table of one prototype game.
+///
+/// @param init loaded messages, config and codebook
+/// @param p1 player 1 of the config
+/// @param p2 player 2 of the config
+/// @param socket_path path of the socket
+///
+/// @return 0 = success, 1 = memory error, 3 = socket could not be created
+//
+static int runServer(const Init &init, Player &p1, Player &p2, const std::string &socket_path)
+{
+  try
+  {
+    Game prototype{p1, p2, init.getErrors(), init.getInfos(), init.getDescriptions(),
+                   init.getMaxRounds(), init.getCreatureCodebook(), init.getSpellCodebook(), nullptr};
+    try
+    {
+      prototype.setSolveTable(std::make_shared<SolveTable>(SOLVE_TABLE_FILE));
+    }
+    catch (const file_error &e)
+    {
+      std::cout << e.what() << std::endl;
+    }
+
+    GameServer server(socket_path, prototype);
+    running_server = &server;
+    std::signal(SIGINT, stopServer);
+    std::signal(SIGTERM, stopServer);
+    std::cout << "Serving games on " << socket_path << std::endl;
+    server.run();
+    running_server = nullptr;
+  }
+  catch (const file_error &e)
+  {
+    std::cout << e.what() << std::endl;
+    return INVALID_FILE;
+  }
+  catch (const MemoryEx &e)
+  {
+    std::cout << MEM_ERROR_MESSAGE << std::endl;
+    return INVALID_MEMORY;
+  }
+  return SUCCESSFUL;
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 ///
 /// The main function
 /// Connects all of the logic of the game together 
 ///
+/// Options after the two file names:
+///   --bot=<1|2>     the player is controlled by the computer
+///   --think=<ms>    think time of the computer players per action
+///   --batch         the first file is a corpus of configs (a file or a directory), all matches are
+///                   played by bots and the results are printed
+///   --parallel=<n>  plays n matches of the batch at the same time
+///   --resume=<file> continues a game saved with the save command instead of starting a new one
+///   --position=<notation>  starts from a position in the notation printed by the position command
+///   --event-log     appends the events of the game (or of all matches) to the event log file
+///   --alloc-stats   counts the allocations and prints them per subsystem, command and round at the end
+///   --bench-scaling=<playouts>  plays this many playouts of the config with 1 up to all hardware
+///                               threads, prints the speedup and exits
+///   --serve=<socket>  hosts games of the config for many clients on a Unix domain socket, one game
+///                     per connection
+///   --build-book=<positions>  searches up to this many opening positions of the deck pairing, stores
+///                             them in the opening book and exits
+///   --check-fights  compares the specialized fight resolvers with the generic one and exits
+///
 /// @param argc number of command line arguments
 /// @param argv command line arguments
 ///
-/// @return 0 = success, 1 = memory error, 2 = wrong num of params, 3 = invalid file
+/// @return 0 = success, 1 = memory error, 2 = wrong num of params, 3 = invalid file, 4 = fight check failed
 //
 int main(int argc, char* argv[])
 {
-  if (argc != 3)
+  if (argc < 3)
+  {
+    std::cout << WRONG_PARAM_MESSAGE << std::endl;
+    return WRONG_NUMBER_OF_PARAMETERS;
+  }
+
+  bool is_bot[2] = {false, false};
+  long think_time = BOT_DEFAULT_THINK_TIME_MS;
+  unsigned long book_positions = 0;
+  bool batch = false;
+  bool log_events = false;
+  bool allocation_stats = false;
+  bool check_fights = false;
+  std::string resume_file;
+  std::string start_position;
+  std::string socket_path;
+  unsigned long benchmark_games = 0;
+  unsigned int parallel_matches = 1;
+  for (int position = 3; position < argc; position++)
+  {
+    std::string option = argv[position];
+    if (option == "--bot=1" || option == "--bot=2")
+    {
+      is_bot[option.back() - '1'] = true;
+    }
+    else if (option.rfind("--think=", 0) == 0 && parseOptionNumber(option.substr(8), think_time))
+    {
+      continue;
+    }
+    else if (option.rfind("--build-book=", 0) == 0 && parseOptionNumber(option.substr(13), book_positions))
+    {
+      continue;
+    }
+    else if (option == "--batch")
+    {
+      batch = true;
+    }
+    else if (option.rfind("--parallel=", 0) == 0 && option.size() < 16 &&
+             parseOptionNumber(option.substr(11), parallel_matches))
+    {
+      parallel_matches = std::max(parallel_matches, 1U);
+    }
+    else if (option.rfind("--resume=", 0) == 0 && option.size() > 9)
+    {
+      resume_file = option.substr(9);
+    }
+    else if (option.rfind("--position=", 0) == 0 && option.size() > 11)
+    {
+      start_position = option.substr(11);
+    }
+    else if (option == "--event-log")
+    {
+      log_events = true;
+    }
+    else if (option == "--alloc-stats")
+    {
+      allocation_stats = true;
+    }
+    else if (option == "--check-fights")
+    {
+      check_fights = true;
+    }
+    else if (option.rfind("--bench-scaling=", 0) == 0 && parseOptionNumber(option.substr(16), benchmark_games))
+    {
+      continue;
+    }
+    else if (option.rfind("--serve=", 0) == 0 && option.size() > 8)
+    {
+      socket_path = option.substr(8);
+    }
+    else
+    {
+      std::cout << WRONG_PARAM_MESSAGE << std::endl;
+      return WRONG_NUMBER_OF_PARAMETERS;
+    }
+  }
+  // the fight check plays no config, it can not be part of a batch
+  if (check_fights && batch)
   {
     std::cout << WRONG_PARAM_MESSAGE << std::endl;
     return WRONG_NUMBER_OF_PARAMETERS;
   }
 
+  if (allocation_stats)
+    AllocationTracker::enable();
+
   Player p1(1, 0, 0, 0);
   Player p2(2, 0, 0, 0);
 
@@ -61,9 +481,10 @@ int main(int argc, char* argv[])
   try
   {
     init.parseMessageLines();
-    init.loadConfig();
-    init.loadCreatureCodes();
-    init.loadSpellCodes();
+    // the codebook defines the spells, the decks of the config need them
+    init.loadCardCodes();
+    if (!batch)
+      init.loadConfig();
   }
   catch (const file_error &e)
   {
@@ -76,65 +497,153 @@ int main(int argc, char* argv[])
     return INVALID_MEMORY;
   }
 
+  if (!socket_path.empty())
+    return runServer(init, p1, p2, socket_path);
+  if (benchmark_games)
+    return runScalingBenchmark(init, p1, p2, benchmark_games);
+  if (check_fights)
+  {
+    Game game{p1, p2, init.getErrors(), init.getInfos(), init.getDescriptions(),
+              init.getMaxRounds(), init.getCreatureCodebook(), init.getSpellCodebook(), nullptr};
+    int differences = game.checkFightResolvers(std::cout);
+    std::cout << "Fight resolvers: " << FIGHT_TRAIT_COMBINATIONS * FIGHT_TRAIT_COMBINATIONS
+              << " trait combinations checked, " << differences << " fights differ" << std::endl;
+    return differences ? CHECK_FAILED : SUCCESSFUL;
+  }
+
+  std::unique_ptr<EventLog> event_log = nullptr;
+  if (log_events)
+  {
+    try
+    {
+      event_log = std::make_unique<EventLog>(EVENT_LOG_FILE);
+    }
+    catch (const file_error &e)
+    {
+      std::cout << e.what() << std::endl;
+    }
+  }
+
+  AllocationReport allocations;
+  if (batch)
+    return runBatch(init, argv[1], think_time, event_log.get(), allocation_stats ? &allocations : nullptr,
+                    parallel_matches);
+
+  AllocationSnapshot allocations_before = AllocationTracker::totals();
+  AllocationTracker::resetPeak();
   Game game{p1, p2, init.getErrors(), init.getInfos(), init.getDescriptions(),
             init.getMaxRounds(), init.getCreatureCodebook(), init.getSpellCodebook()};
+  if (event_log)
+    game.setEventStream(event_log->openGame(0));
+  if (allocation_stats)
+    game.setAllocationReport(&allocations);
   CommandLine commandLine;
 
-  int game_status = 0;
-  int battle_status = 0;
-  try
+  if (!resume_file.empty())
   {
-    while (!(game_status = game.startRound()))
+    std::ifstream file(resume_file, std::ios::binary);
+    std::vector<uint8_t> state((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!file || !game.restoreState(state))
     {
-      while (true)
-      {
-        Command command = commandLine.readCommand(game.getAttackerNumber());
-        if (command.isQuit())
-          return SUCCESSFUL;
-        else if (command.isDone())
-        {
-          game.setRedrawFalse(game.getAttacker());
-          game.applyTraits(game.getAttackerNumber());
-          game.printBoard();
-          break;
-        }
+      std::cout << file_error(resume_file).what() << std::endl;
+      return INVALID_FILE;
+    }
+  }
+  if (!start_position.empty() && !game.loadNotation(start_position))
+  {
+    std::cout << INVALID_POSITION_MESSAGE << std::endl;
+    return WRONG_NUMBER_OF_PARAMETERS;
+  }
 
-        game.processCommand(game.getAttacker(), command);
-      }
+  std::shared_ptr<SolveTable> solve_table = nullptr;
+  if (is_bot[0] || is_bot[1] || book_positions)
+  {
+    try
+    {
+      solve_table = std::make_shared<SolveTable>(SOLVE_TABLE_FILE);
+    }
+    catch (const file_error &e)
+    {
+      std::cout << e.what() << std::endl;
+    }
+  }
 
-      while (true)
-      {
-        Command command = commandLine.readCommand(game.getDefenderNumber());
-        if (command.isQuit())
-          return SUCCESSFUL;
-        else if (command.isDone())
-        {
-          game.setRedrawFalse(game.getDefender());
-          game.applyTraits(game.getDefenderNumber());
-          game.printBoard();
-          break;
-        }
+  if (book_positions)
+  {
+    try
+    {
+      OpeningBook book(OPENING_BOOK_FILE, true);
+      unsigned long added = book.build(game, solve_table, std::chrono::milliseconds(think_time), book_positions);
+      std::cout << "Opening book: " << added << " positions added to " << OPENING_BOOK_FILE << std::endl;
+    }
+    catch (const file_error &e)
+    {
+      std::cout << e.what() << std::endl;
+      return INVALID_FILE;
+    }
+    catch (const MemoryEx &e)
+    {
+      std::cout << MEM_ERROR_MESSAGE << std::endl;
+      return INVALID_MEMORY;
+    }
+    return SUCCESSFUL;
+  }
 
-        game.processCommand(game.getDefender(), command);
-      }
+  // the opening book is optional, bots search the opening themselves if it has not been built
+  std::shared_ptr<const OpeningBook> opening_book = nullptr;
+  if (is_bot[0] || is_bot[1])
+  {
+    try
+    {
+      opening_book = std::make_shared<const OpeningBook>(OPENING_BOOK_FILE, false);
+    }
+    catch (const file_error &e)
+    {
+    }
+  }
 
-      battle_status = game.battlePhase();
-      if (battle_status == 1)
-      {
-        game_status = 4;
-        break;
-      }
-      else if (battle_status == 2)
-      {
-        game_status = 3;
-        break;
-      }
-      else if (battle_status == 7)
+  std::unique_ptr<PlayerController> controllers[2];
+  for (int player = 0; player < 2; player++)
+  {
+    if (!is_bot[player])
+    {
+      controllers[player] = std::make_unique<HumanController>(commandLine, player + 1);
+      continue;
+    }
+    std::unique_ptr<Bot> bot = std::make_unique<Bot>(player + 1, std::chrono::milliseconds(think_time), solve_table);
+    bot->setOpeningBook(opening_book);
+    controllers[player] = std::make_unique<BotController>(std::move(bot));
+  }
+
+  int game_status = 0;
+  try
+  {
+    // a resumed game or a loaded position continues in the middle of its round
+    TurnSession turns = TurnSession::play(game, resume_file.empty() && start_position.empty());
+    bool pondering = false;
+    uint64_t pondered_position = 0;
+    while (!turns.isFinished())
+    {
+      PlayerController &controller = *controllers[turns.getPlayer() - 1];
+      PlayerController &opponent = *controllers[2 - turns.getPlayer()];
+
+      // a computer opponent keeps searching while the human is thinking, commands that do not change the
+      // position (e.g. hand or status) let it search on
+      if (!controller.isHuman())
+        pondering = false;
+      else if (!pondering || game.positionHash() != pondered_position)
       {
-        game_status = 7;
-        break;
+        opponent.startPondering(game);
+        pondering = true;
+        pondered_position = game.positionHash();
       }
+      controller.startTurn(game);
+      Command command = awaitAction(controller, commandLine);
+      turns.resume(command);
     }
+    controllers[0]->stopPondering();
+    controllers[1]->stopPondering();
+    game_status = turns.getGameStatus();
   }
   catch (const MemoryEx &e)
   {
@@ -142,7 +651,13 @@ int main(int argc, char* argv[])
     return INVALID_MEMORY;
   }
 
-  game.endGame(game_status, argv[1]);
+  if (game_status)
+    game.endGame(game_status, argv[1]);
 
+  if (allocation_stats)
+  {
+    allocations.finishGame(AllocationTracker::totals() - allocations_before, AllocationTracker::getPeakBytes());
+    allocations.print(std::cout);
+  }
   return SUCCESSFUL;
 }